@@ -0,0 +1,350 @@
+#include "frame_stream.h"
+
+// Pure C (no ESP-IDF calls) so the host encoder and loopback test share it.
+
+enum {
+    ST_SYNC0, ST_SYNC1, ST_TYPE, ST_SEQ, ST_LEN0, ST_LEN1, ST_PAYLOAD, ST_CRC0, ST_CRC1
+};
+
+enum { SUB_TOKEN, SUB_VARINT };
+
+// ------------ CRC-16/CCITT-FALSE -------------
+uint16_t stream_crc16(uint16_t crc, const uint8_t *data, size_t len)
+{
+    while (len--) {
+        crc ^= (uint16_t)(*data++) << 8;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+// ------------ Encoder -------------
+static inline uint8_t enc_val(const uint8_t *pix, const uint8_t *prev, size_t i)
+{
+    return (prev ? pix[i] ^ prev[i] : pix[i]) & 0x07;
+}
+
+// Length of the run of equal values starting at i, up to max
+static inline size_t enc_run(const uint8_t *pix, const uint8_t *prev, size_t i, size_t n, size_t max)
+{
+    uint8_t v = enc_val(pix, prev, i);
+    size_t r = 1;
+    while (i + r < n && r < max && enc_val(pix, prev, i + r) == v) r++;
+    return r;
+}
+
+size_t stream_rle_encode(const uint8_t *pix, const uint8_t *prev, size_t n,
+                         uint8_t *out, size_t cap)
+{
+    size_t o = 0, i = 0;
+
+    while (i < n) {
+        size_t r = enc_run(pix, prev, i, n, n);
+
+        if (r >= 3) {
+            // Run: one token, plus a varint past 15 pixels
+            uint8_t v = enc_val(pix, prev, i);
+            if (o + 1 > cap) return 0;
+            if (r < 16) {
+                out[o++] = 0x80 | (v << 4) | (uint8_t)(r - 1);
+            } else {
+                out[o++] = 0x80 | (v << 4) | 0x0F;
+                uint32_t ext = (uint32_t)(r - 16);
+                do {
+                    if (o + 1 > cap) return 0;
+                    uint8_t b = ext & 0x7F;
+                    ext >>= 7;
+                    out[o++] = ext ? (b | 0x80) : b;
+                } while (ext);
+            }
+            i += r;
+            continue;
+        }
+
+        // Literal: up to 128 pixels, stopping where a run of 3+ starts
+        size_t start = i, cnt = 0;
+        while (i < n && cnt < 128 && enc_run(pix, prev, i, n, 3) < 3) {
+            i++;
+            cnt++;
+        }
+        if (cnt == 0) continue;   // a run starts right here
+
+        if (o + 1 + (cnt + 1) / 2 > cap) return 0;
+        out[o++] = (uint8_t)(cnt - 1);
+        for (size_t k = 0; k < cnt; k += 2) {
+            uint8_t lo = enc_val(pix, prev, start + k);
+            uint8_t hi = (k + 1 < cnt) ? enc_val(pix, prev, start + k + 1) : 0;
+            out[o++] = lo | (hi << 4);
+        }
+    }
+    return o;
+}
+
+size_t stream_encode_frame(uint8_t type, uint8_t seq, const uint8_t *pix,
+                           const uint8_t *prev, size_t n, uint8_t *out, size_t cap)
+{
+    if (cap < STREAM_HEADER_LEN + STREAM_CRC_LEN) return 0;
+
+    size_t len = stream_rle_encode(pix, type == STREAM_DELTA ? prev : NULL, n,
+                                   out + STREAM_HEADER_LEN,
+                                   cap - STREAM_HEADER_LEN - STREAM_CRC_LEN);
+    if (len == 0 || len > 0xFFFF) return 0;
+
+    out[0] = STREAM_SYNC0;
+    out[1] = STREAM_SYNC1;
+    out[2] = type;
+    out[3] = seq;
+    out[4] = len & 0xFF;
+    out[5] = len >> 8;
+
+    uint16_t crc = stream_crc16(0xFFFF, out + 2, STREAM_HEADER_LEN - 2 + len);
+    out[STREAM_HEADER_LEN + len]     = crc & 0xFF;
+    out[STREAM_HEADER_LEN + len + 1] = crc >> 8;
+    return STREAM_HEADER_LEN + len + STREAM_CRC_LEN;
+}
+
+size_t stream_encode_capture(uint8_t seq, const uint8_t *pix, uint16_t w, uint16_t h,
+                             uint8_t *out, size_t cap)
+{
+    const size_t hdr = STREAM_HEADER_LEN + 4;
+    if (cap < hdr + STREAM_CRC_LEN) return 0;
+
+    size_t rle = stream_rle_encode(pix, NULL, (size_t)w * h, out + hdr,
+                                   cap - hdr - STREAM_CRC_LEN);
+    size_t len = 4 + rle;
+    if (rle == 0 || len > 0xFFFF) return 0;
+
+    out[0] = STREAM_SYNC0;
+    out[1] = STREAM_SYNC1;
+    out[2] = STREAM_CAPTURE;
+    out[3] = seq;
+    out[4] = len & 0xFF;
+    out[5] = len >> 8;
+    out[6] = w & 0xFF;
+    out[7] = w >> 8;
+    out[8] = h & 0xFF;
+    out[9] = h >> 8;
+
+    uint16_t crc = stream_crc16(0xFFFF, out + 2, STREAM_HEADER_LEN - 2 + len);
+    out[STREAM_HEADER_LEN + len]     = crc & 0xFF;
+    out[STREAM_HEADER_LEN + len + 1] = crc >> 8;
+    return STREAM_HEADER_LEN + len + STREAM_CRC_LEN;
+}
+
+// ------------ Decoder -------------
+void frame_decoder_init(frame_decoder_t *d, uint8_t *ref, size_t n_pixels)
+{
+    *d = (frame_decoder_t){
+        .ref        = ref,
+        .n_pixels   = n_pixels,
+        .out_copies = 1,
+        .need_key   = true,
+        .state      = ST_SYNC0,
+    };
+}
+
+// Bad frame that never touched ref (wrong type/length, 'R' CRC): just drop it
+static void dec_drop(frame_decoder_t *d)
+{
+    d->frames_bad++;
+    d->state = ST_SYNC0;
+}
+
+// Bad K/D frame whose payload was already decoded into ref
+static void dec_error(frame_decoder_t *d)
+{
+    dec_drop(d);
+    d->need_key = true;
+}
+
+static inline void dec_emit(frame_decoder_t *d, uint8_t v)
+{
+    size_t i = d->pos++;
+    uint8_t p = (d->type == STREAM_DELTA) ? d->ref[i] ^ v : v;
+    d->ref[i] = p;
+    if (d->out) {
+        for (int k = 0; k < d->out_copies; k++) {
+            d->out[k * d->out_stride + i] = p;
+        }
+    }
+}
+
+static bool dec_run(frame_decoder_t *d, uint32_t n)
+{
+    if (n > d->n_pixels - d->pos) return false;
+    while (n--) dec_emit(d, d->run_val);
+    return true;
+}
+
+// One payload byte; false on a malformed stream
+static bool dec_payload(frame_decoder_t *d, uint8_t b)
+{
+    if (d->lit_left) {
+        dec_emit(d, b & 0x07);
+        if (--d->lit_left) {
+            dec_emit(d, (b >> 4) & 0x07);
+            d->lit_left--;
+        }
+        return true;
+    }
+
+    if (d->sub == SUB_VARINT) {
+        if (d->varint_shift > 21) return false;
+        d->varint |= (uint32_t)(b & 0x7F) << d->varint_shift;
+        d->varint_shift += 7;
+        if (b & 0x80) return true;
+        d->sub = SUB_TOKEN;
+        return dec_run(d, 16 + d->varint);
+    }
+
+    if (b < 0x80) {
+        d->lit_left = b + 1;
+        return d->lit_left <= d->n_pixels - d->pos;
+    }
+
+    d->run_val = (b >> 4) & 0x07;
+    if ((b & 0x0F) != 0x0F) {
+        return dec_run(d, (b & 0x0F) + 1);
+    }
+    d->sub          = SUB_VARINT;
+    d->varint       = 0;
+    d->varint_shift = 0;
+    return true;
+}
+
+static void dec_start_payload(frame_decoder_t *d)
+{
+    if (d->type == STREAM_CAPTURE_REQ) {
+        d->skip  = false;
+        d->state = ST_CRC0;
+        if (d->len != 0) dec_drop(d);
+        return;
+    }
+    // Nothing below has touched ref yet. A lost K/D frame needs no resync:
+    // the next delta's seq no longer follows last_seq, so it is skipped.
+    if (d->type != STREAM_KEYFRAME && d->type != STREAM_DELTA) {
+        dec_drop(d);
+        return;
+    }
+    if (d->len > STREAM_RLE_MAX(d->n_pixels)) {
+        dec_drop(d);
+        return;
+    }
+
+    // A delta is only usable on top of the frame right before it
+    d->skip = d->type == STREAM_DELTA &&
+              (d->need_key || d->seq != (uint8_t)(d->last_seq + 1));
+    if (d->skip) d->need_key = true;
+    if (!d->skip && d->len == 0) {   // an empty payload never makes a frame
+        dec_drop(d);
+        return;
+    }
+
+    d->pos      = 0;
+    d->lit_left = 0;
+    d->sub      = SUB_TOKEN;
+    d->out      = (!d->skip && d->frame_begin) ? d->frame_begin(d->ctx) : NULL;
+    d->got      = 0;
+    d->state    = d->len ? ST_PAYLOAD : ST_CRC0;
+}
+
+static void dec_end_frame(frame_decoder_t *d)
+{
+    d->state = ST_SYNC0;
+
+    if (d->rx_crc != d->crc) {
+        // Only a decoded K/D payload has dirtied ref
+        if (d->type == STREAM_CAPTURE_REQ || d->skip) {
+            dec_drop(d);
+        } else {
+            dec_error(d);
+        }
+        return;
+    }
+    if (d->type == STREAM_CAPTURE_REQ) {
+        if (d->capture_request) d->capture_request(d->ctx);
+        return;
+    }
+    if (d->skip) {
+        d->frames_skipped++;
+        return;
+    }
+    d->frames_ok++;
+    d->last_seq = d->seq;
+    d->need_key = false;
+    if (d->frame_done) d->frame_done(d->ctx);
+}
+
+bool stream_rle_decode(const uint8_t *in, size_t len, uint8_t *out, size_t n)
+{
+    // Reuse the incremental payload parser on a keyframe-typed scratch state
+    frame_decoder_t d = {
+        .ref      = out,
+        .n_pixels = n,
+        .type     = STREAM_KEYFRAME,
+    };
+    for (size_t i = 0; i < len; i++) {
+        if (!dec_payload(&d, in[i])) return false;
+    }
+    return d.pos == n && d.lit_left == 0 && d.sub == SUB_TOKEN;
+}
+
+void frame_decoder_feed(frame_decoder_t *d, const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        uint8_t b = data[i];
+
+        switch (d->state) {
+        case ST_SYNC0:
+            if (b == STREAM_SYNC0) d->state = ST_SYNC1;
+            break;
+        case ST_SYNC1:
+            d->state = (b == STREAM_SYNC1) ? ST_TYPE : (b == STREAM_SYNC0 ? ST_SYNC1 : ST_SYNC0);
+            break;
+        case ST_TYPE:
+            d->type  = b;
+            d->crc   = stream_crc16(0xFFFF, &b, 1);
+            d->state = ST_SEQ;
+            break;
+        case ST_SEQ:
+            d->seq   = b;
+            d->crc   = stream_crc16(d->crc, &b, 1);
+            d->state = ST_LEN0;
+            break;
+        case ST_LEN0:
+            d->len   = b;
+            d->crc   = stream_crc16(d->crc, &b, 1);
+            d->state = ST_LEN1;
+            break;
+        case ST_LEN1:
+            d->len  |= (uint16_t)b << 8;
+            d->crc   = stream_crc16(d->crc, &b, 1);
+            dec_start_payload(d);
+            break;
+        case ST_PAYLOAD:
+            d->crc = stream_crc16(d->crc, &b, 1);
+            if (!d->skip && !dec_payload(d, b)) {
+                dec_error(d);
+                break;
+            }
+            if (++d->got == d->len) {
+                if (!d->skip && (d->pos != d->n_pixels || d->lit_left || d->sub != SUB_TOKEN)) {
+                    dec_error(d);
+                    break;
+                }
+                d->state = ST_CRC0;
+            }
+            break;
+        case ST_CRC0:
+            d->rx_crc = b;
+            d->state  = ST_CRC1;
+            break;
+        case ST_CRC1:
+            d->rx_crc |= (uint16_t)b << 8;
+            dec_end_frame(d);
+            break;
+        }
+    }
+}
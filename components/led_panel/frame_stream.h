@@ -0,0 +1,98 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// ------------ Frame stream protocol -------------
+//
+// Frames of packed 3-bit pixels (bit0=R, bit1=G, bit2=B) in physical chain
+// order, y-major: PHY_HEIGHT x PHY_WIDTH. Little-endian on the wire:
+//
+//   A5 5A  type  seq  len_lo len_hi  payload[len]  crc_lo crc_hi
+//
+//   type  'K' keyframe: payload is RLE of the pixels
+//         'D' delta:    payload is RLE of (pixel XOR previous frame);
+//                       seq must be previous seq + 1
+//         'R' capture request (host -> sign), empty payload
+//         'C' capture (sign -> host): width, height (u16 each), then RLE
+//                       of the pixels in virtual VIRT_WIDTH x VIRT_HEIGHT
+//                       layout, y-major
+//   crc   CRC-16/CCITT-FALSE over type, seq, len and payload
+//
+// RLE tokens:
+//   0x00..0x7F  literal: n = T + 1 pixels follow, two per byte, low nibble
+//               first (unused high nibble of an odd tail is 0)
+//   0x80..0xFF  run of value (T >> 4) & 7: n = (T & 0x0F) + 1, or if
+//               T & 0x0F == 0x0F, n = 16 + LEB128 varint that follows
+//
+#define STREAM_SYNC0       0xA5
+#define STREAM_SYNC1       0x5A
+#define STREAM_KEYFRAME    'K'
+#define STREAM_DELTA       'D'
+#define STREAM_CAPTURE_REQ 'R'
+#define STREAM_CAPTURE     'C'
+#define STREAM_HEADER_LEN  6
+#define STREAM_CRC_LEN     2
+
+// Worst case payload for n pixels (all literals). len is 16 bits, so a
+// frame is limited to STREAM_RLE_MAX(n) <= 0xFFFF (about 64K pixels).
+#define STREAM_RLE_MAX(n)  ((n) + ((n) + 127) / 128)
+
+uint16_t stream_crc16(uint16_t crc, const uint8_t *data, size_t len);
+
+// RLE-encode n pixels; with prev != NULL the XOR against prev is encoded.
+// Returns payload length, or 0 if it does not fit in cap.
+size_t stream_rle_encode(const uint8_t *pix, const uint8_t *prev, size_t n,
+                         uint8_t *out, size_t cap);
+
+// Full wire frame (header + payload + crc). Returns length, 0 if it does not fit.
+size_t stream_encode_frame(uint8_t type, uint8_t seq, const uint8_t *pix,
+                           const uint8_t *prev, size_t n, uint8_t *out, size_t cap);
+
+// Capture frame of a w x h image. Returns length, 0 if it does not fit.
+size_t stream_encode_capture(uint8_t seq, const uint8_t *pix, uint16_t w, uint16_t h,
+                             uint8_t *out, size_t cap);
+
+// Decode a complete RLE payload into exactly n pixels; false if malformed.
+bool stream_rle_decode(const uint8_t *in, size_t len, uint8_t *out, size_t n);
+
+// ------------ Incremental decoder -------------
+//
+// Feed bytes as they arrive. Pixels are decoded straight into ref (the
+// current frame, also the base for the next delta) and mirrored into the
+// buffer returned by frame_begin, out_copies times, out_stride bytes apart.
+// frame_done runs once the CRC checks out. A bad K/D frame leaves ref dirty,
+// so deltas are ignored until the next keyframe; other bad frames (capture
+// requests, unknown types) are only counted.
+//
+typedef struct {
+    // set by the caller
+    uint8_t *ref;                         // n_pixels bytes, decoded frame
+    size_t   n_pixels;
+    int      out_copies;                  // e.g. dither subframes
+    size_t   out_stride;
+    uint8_t *(*frame_begin)(void *ctx);   // may return NULL: decode into ref only
+    void     (*frame_done)(void *ctx);
+    void     (*capture_request)(void *ctx); // 'R' frame received, may be NULL
+    void    *ctx;
+
+    // counters
+    uint32_t frames_ok;
+    uint32_t frames_bad;                  // CRC, length or RLE errors
+    uint32_t frames_skipped;              // deltas without a valid base
+
+    // state
+    uint8_t  state, sub;
+    uint8_t  type, seq, last_seq;
+    bool     need_key, skip;
+    uint16_t len, got, crc, rx_crc;
+    uint8_t *out;
+    size_t   pos;                         // pixels decoded
+    uint32_t run_left, lit_left;
+    uint8_t  run_val;
+    uint32_t varint;
+    uint8_t  varint_shift;
+} frame_decoder_t;
+
+void frame_decoder_init(frame_decoder_t *d, uint8_t *ref, size_t n_pixels);
+void frame_decoder_feed(frame_decoder_t *d, const uint8_t *data, size_t len);
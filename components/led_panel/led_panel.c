@@ -1,10 +1,60 @@
 #include "led_panel.h"
 #include "driver/gpio.h"
 #include "driver/ledc.h"
+#include "hal/ledc_ll.h"     // register-level OE duty writes for the refresh path
+#include "esp_idf_version.h"
 #include "font20x40.h"
 
 
 #include "soc/gpio_struct.h"  // for GPIO register access
+#include "esp_attr.h"         // IRAM_ATTR
+
+#if LED_PANEL_REFRESH_ISR
+#include "sdkconfig.h"
+#include "driver/gptimer.h"
+
+#if !CONFIG_GPTIMER_ISR_IRAM_SAFE || !CONFIG_GPTIMER_CTRL_FUNC_IN_IRAM
+#error "LED_PANEL_REFRESH_ISR needs CONFIG_GPTIMER_ISR_IRAM_SAFE and CONFIG_GPTIMER_CTRL_FUNC_IN_IRAM (see sdkconfig.defaults)"
+#endif
+#endif
+
+#include "esp_cpu.h"          // esp_cpu_get_cycle_count()
+#include "esp_rom_sys.h"
+#include "esp_log.h"
+#include <inttypes.h>
+#include <math.h>
+#include <stdlib.h>
+
+#if LED_PANEL_STREAM_UART
+#include "driver/uart.h"
+#include "freertos/semphr.h"
+#endif
+
+#if FB_SUBFRAMES != 1 && FB_SUBFRAMES != 2 && FB_SUBFRAMES != 4 && FB_SUBFRAMES != 8
+#error "LED_PANEL_DITHER_FRAMES must be 1, 2, 4 or 8"
+#endif
+
+#if !LED_PANEL_FB_PSRAM
+_Static_assert((2 + LED_PANEL_TRIPLE_BUFFER) * FB_BYTES <= LED_PANEL_FB_INTERNAL_MAX,
+               "framebuffers exceed LED_PANEL_FB_INTERNAL_MAX of internal DRAM: "
+               "lower LED_PANEL_DITHER_FRAMES or use LED_PANEL_FB_PSRAM");
+#endif
+
+#if LED_PANEL_FB_PSRAM
+#include "sdkconfig.h"
+#include "esp_heap_caps.h"
+
+#if !CONFIG_SPIRAM
+#error "LED_PANEL_FB_PSRAM needs CONFIG_SPIRAM"
+#endif
+#if LED_PANEL_REFRESH_ISR
+#error "LED_PANEL_FB_PSRAM: PSRAM is unreachable while the flash cache is off; use the refresh task"
+#endif
+#endif
+
+#if LED_PANEL_STATS || LED_PANEL_FB_PSRAM || LED_PANEL_STREAM_UART
+static const char *TAG = "led_panel";
+#endif
 
 // Precalculate bitmasks for speed
 #define BIT_R1 (1 << PIN_R1)
@@ -23,7 +73,7 @@
 
 
 
-static inline void set_rgb_lines(uint8_t p1, uint8_t p2) {
+static inline IRAM_ATTR void set_rgb_lines(uint8_t p1, uint8_t p2) {
     uint32_t set_mask = 0;
     uint32_t clr_mask = 0;
 
@@ -42,7 +92,7 @@ static inline void set_rgb_lines(uint8_t p1, uint8_t p2) {
     GPIO.out_w1tc = clr_mask; // set bits low
 }
 
-static inline void set_row(uint8_t row)
+static inline IRAM_ATTR void set_row(uint8_t row)
 {
     uint32_t set_mask = 0;
     uint32_t clr_mask = 0;
@@ -56,12 +106,12 @@ static inline void set_row(uint8_t row)
 }
 
 
-static inline void pulse_clk(void) {
+static inline IRAM_ATTR void pulse_clk(void) {
     GPIO.out_w1ts = BIT_CLK; // set high
     GPIO.out_w1tc = BIT_CLK; // set low
 }
 
-static inline void pulse_lat(void) {
+static inline IRAM_ATTR void pulse_lat(void) {
     GPIO.out_w1ts = BIT_LAT; // set high
     GPIO.out_w1tc = BIT_LAT; // set low
 }
@@ -134,6 +184,71 @@ void set_global_brightness(uint8_t level)
 
 
 
+// ------------ Framebuffers -------------
+#if LED_PANEL_FB_PSRAM
+static pix_t (*fbA)[PHY_WIDTH];
+static pix_t (*fbB)[PHY_WIDTH];
+#if LED_PANEL_TRIPLE_BUFFER
+static pix_t (*fbC)[PHY_WIDTH];
+#endif
+
+static volatile pix_t (*front_buf)[PHY_WIDTH]; // scanned by refresh task
+static volatile pix_t (*back_buf)[PHY_WIDTH];  // drawn by your code
+#if LED_PANEL_TRIPLE_BUFFER
+static volatile pix_t (*ready_buf)[PHY_WIDTH]; // mailbox: newest finished frame
+#endif
+#else
+static pix_t fbA[FB_SUBFRAMES * PHY_HEIGHT][PHY_WIDTH];
+static pix_t fbB[FB_SUBFRAMES * PHY_HEIGHT][PHY_WIDTH];
+#if LED_PANEL_TRIPLE_BUFFER
+static pix_t fbC[FB_SUBFRAMES * PHY_HEIGHT][PHY_WIDTH];
+#endif
+
+static volatile pix_t (*front_buf)[PHY_WIDTH] = fbA; // scanned by refresh task
+static volatile pix_t (*back_buf)[PHY_WIDTH]  = fbB; // drawn by your code
+#if LED_PANEL_TRIPLE_BUFFER
+static volatile pix_t (*ready_buf)[PHY_WIDTH] = fbC; // mailbox: newest finished frame
+#endif
+#endif
+
+#if LED_PANEL_TRIPLE_BUFFER
+// ready_fresh: ready_buf holds a frame refresh has not picked up yet
+static DRAM_ATTR volatile uint8_t ready_fresh;
+static DRAM_ATTR portMUX_TYPE fb_mux = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
+static void init_dither_tables(void);
+
+void init_framebuffers(void)
+{
+    init_dither_tables();
+
+#if LED_PANEL_FB_PSRAM
+    fbA = heap_caps_calloc(1, FB_BYTES, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    fbB = heap_caps_calloc(1, FB_BYTES, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!fbA || !fbB) {
+        ESP_LOGE(TAG, "no PSRAM for 2 x %u byte framebuffers", (unsigned)FB_BYTES);
+        ESP_ERROR_CHECK(ESP_ERR_NO_MEM);
+    }
+    front_buf = fbA;
+    back_buf  = fbB;
+#if LED_PANEL_TRIPLE_BUFFER
+    fbC = heap_caps_calloc(1, FB_BYTES, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!fbC) {
+        ESP_LOGE(TAG, "no PSRAM for the third %u byte framebuffer", (unsigned)FB_BYTES);
+        ESP_ERROR_CHECK(ESP_ERR_NO_MEM);
+    }
+    ready_buf = fbC;
+#endif
+#else
+    memset(fbA, 0, FB_BYTES);
+    memset(fbB, 0, FB_BYTES);
+#if LED_PANEL_TRIPLE_BUFFER
+    memset(fbC, 0, FB_BYTES);
+#endif
+#endif
+}
+
 // ------------ Pins init -------------
 void init_pins(void) {
     uint64_t mask = (1ULL<<PIN_R1) | (1ULL<<PIN_G1) | (1ULL<<PIN_B1)
@@ -155,18 +270,349 @@ void init_pins(void) {
     gpio_set_level(PIN_CLK, 0);
 }
 
+// ------------ Runtime stats -------------
+//
+// Everything is counted in CPU cycles (per-core counter; each value is only
+// ever measured on one core) and converted to microseconds on read.
+// Window values (fps, maxima, jitter) are latched once per second by the
+// refresh task, so readers never have to reset anything. The latch is
+// wrapped in a sequence counter (odd while it is being written) so a reader
+// on the other core never mixes two windows.
+//
+#if LED_PANEL_STATS
+
+static struct {
+    // latched / cumulative, read by get_panel_stats()
+    uint32_t frames, swaps, drops;
+    uint32_t fps, swaps_per_sec;
+    uint32_t shift_last, shift_max;
+    uint32_t on_last, on_max;
+    uint32_t frame_min, frame_max;
+    volatile uint32_t win_seq;
+    uint32_t render_hist[RENDER_HIST_BINS];
+    uint32_t refresh_stack_free, render_stack_free;
+
+    // refresh-side window accumulators
+    uint32_t frame_start, win_start, win_frames, win_swaps;
+    uint32_t win_shift_max, win_on_max, win_frame_min, win_frame_max;
+
+    // render-side
+    uint32_t render_start;
+} stats;
+
+#define STATS_NOW() esp_cpu_get_cycle_count()
+
+static inline IRAM_ATTR void stats_row_done(uint32_t t_shift, uint32_t t_on, uint32_t t_end)
+{
+    uint32_t shift = t_on - t_shift;
+    uint32_t on    = t_end - t_on;
+    stats.shift_last = shift;
+    stats.on_last    = on;
+    if (shift > stats.win_shift_max) stats.win_shift_max = shift;
+    if (on    > stats.win_on_max)    stats.win_on_max    = on;
+}
+
+static inline IRAM_ATTR void stats_frame_done(uint32_t now)
+{
+    const uint32_t cycles_per_sec = esp_rom_get_cpu_ticks_per_us() * 1000000u;
+
+    uint32_t period = now - stats.frame_start;
+    stats.frame_start = now;
+    if (period < stats.win_frame_min) stats.win_frame_min = period;
+    if (period > stats.win_frame_max) stats.win_frame_max = period;
+    stats.frames++;
+    stats.win_frames++;
+
+    if (now - stats.win_start >= cycles_per_sec) {
+        uint32_t swaps = stats.swaps;
+        stats.win_seq++;
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        stats.fps           = stats.win_frames;
+        stats.swaps_per_sec = swaps - stats.win_swaps;
+        stats.shift_max     = stats.win_shift_max;
+        stats.on_max        = stats.win_on_max;
+        stats.frame_min     = stats.win_frame_min;
+        stats.frame_max     = stats.win_frame_max;
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        stats.win_seq++;
+
+        stats.win_start     = now;
+        stats.win_frames    = 0;
+        stats.win_swaps     = swaps;
+        stats.win_shift_max = 0;
+        stats.win_on_max    = 0;
+        stats.win_frame_min = UINT32_MAX;
+        stats.win_frame_max = 0;
+    }
+
+#if !LED_PANEL_REFRESH_ISR
+    // Stack scan is not free; sample it rarely
+    if ((stats.frames & 0xFF) == 0) {
+        stats.refresh_stack_free = uxTaskGetStackHighWaterMark(NULL);
+    }
+#endif
+}
+
+static inline void stats_refresh_start(void)
+{
+    uint32_t now = STATS_NOW();
+    stats.frame_start   = now;
+    stats.win_start     = now;
+    stats.win_frame_min = UINT32_MAX;
+}
+
+static inline void stats_render_start(void)
+{
+    stats.render_start = STATS_NOW();
+}
+
+static inline void stats_frame_dropped(void)
+{
+    stats.drops++;
+}
+
+static inline void stats_render_done(void)
+{
+    uint32_t start = stats.render_start;
+    stats.swaps++;
+    if (start == 0) return;   // swap without a preceding clear_back_buffer()
+    stats.render_start = 0;
+
+    uint32_t us  = (STATS_NOW() - start) / esp_rom_get_cpu_ticks_per_us();
+    uint32_t bin = (us >> 7) ? 32 - __builtin_clz(us >> 7) : 0;
+    if (bin >= RENDER_HIST_BINS) bin = RENDER_HIST_BINS - 1;
+    stats.render_hist[bin]++;
+
+    if ((stats.swaps & 0x3F) == 0) {
+        stats.render_stack_free = uxTaskGetStackHighWaterMark(NULL);
+    }
+}
+
+void get_panel_stats(panel_stats_t *out)
+{
+    const uint32_t tpu = esp_rom_get_cpu_ticks_per_us();
+    uint32_t seq, fps, swaps_per_sec, shift_max, on_max, frame_min, frame_max;
+
+    // One consistent window; retry if refresh latched a new one meanwhile
+    do {
+        seq = stats.win_seq;
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        fps           = stats.fps;
+        swaps_per_sec = stats.swaps_per_sec;
+        shift_max     = stats.shift_max;
+        on_max        = stats.on_max;
+        frame_min     = stats.frame_min;
+        frame_max     = stats.frame_max;
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    } while ((seq & 1) || seq != stats.win_seq);
+
+    out->frames             = stats.frames;
+    out->swaps              = stats.swaps;
+    out->drops              = stats.drops;
+    out->fps                = fps;
+    out->swaps_per_sec      = swaps_per_sec;
+    out->shift_us_last      = stats.shift_last / tpu;
+    out->shift_us_max       = shift_max / tpu;
+    out->on_us_last         = stats.on_last / tpu;
+    out->on_us_max          = on_max / tpu;
+    out->frame_us_min       = frame_min / tpu;
+    out->frame_us_max       = frame_max / tpu;
+    memcpy(out->render_hist, stats.render_hist, sizeof(out->render_hist));
+    out->refresh_stack_free = stats.refresh_stack_free;
+    out->render_stack_free  = stats.render_stack_free;
+}
+
+void log_panel_stats(void)
+{
+    panel_stats_t s;
+    get_panel_stats(&s);
+
+    ESP_LOGI(TAG, "refresh: %" PRIu32 " fps, frame %" PRIu32 "..%" PRIu32 " us (jitter %" PRIu32 " us), "
+                  "row shift %" PRIu32 "/%" PRIu32 " us, on %" PRIu32 "/%" PRIu32 " us (last/max)",
+             s.fps, s.frame_us_min, s.frame_us_max, s.frame_us_max - s.frame_us_min,
+             s.shift_us_last, s.shift_us_max, s.on_us_last, s.on_us_max);
+    ESP_LOGI(TAG, "render: %" PRIu32 " swaps/s, %" PRIu32 " dropped, hist <128us:%" PRIu32
+                  " <256:%" PRIu32 " <512:%" PRIu32 " <1ms:%" PRIu32 " <2ms:%" PRIu32
+                  " <4ms:%" PRIu32 " <8ms:%" PRIu32 " >=8ms:%" PRIu32,
+             s.swaps_per_sec, s.drops, s.render_hist[0], s.render_hist[1], s.render_hist[2],
+             s.render_hist[3], s.render_hist[4], s.render_hist[5], s.render_hist[6],
+             s.render_hist[7]);
+#if LED_PANEL_REFRESH_ISR
+    // Refresh runs in the timer ISR on the interrupt stack: nothing to sample
+    ESP_LOGI(TAG, "stack free: refresh n/a (ISR), render %" PRIu32 " B", s.render_stack_free);
+#else
+    ESP_LOGI(TAG, "stack free: refresh %" PRIu32 " B, render %" PRIu32 " B",
+             s.refresh_stack_free, s.render_stack_free);
+#endif
+}
+
+void panel_stats_task(void *arg)
+{
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(STATS_LOG_PERIOD_MS));
+        log_panel_stats();
+    }
+}
+
+#else
+
+#define stats_refresh_start()          do { } while (0)
+#define stats_row_done(t0, t1, t2)     do { (void)(t0); (void)(t1); (void)(t2); } while (0)
+#define stats_frame_done(now)          do { (void)(now); } while (0)
+#define stats_render_start()           do { } while (0)
+#define stats_render_done()            do { } while (0)
+#define stats_frame_dropped()          do { } while (0)
+#define STATS_NOW()                    0u
+
+#endif
+
 // ------------ Buffer helpers -------------
 void clear_back_buffer(void) {
+    stats_render_start();
     // Clear whole physical surface: PHY_HEIGHT x PHY_WIDTH
-    memset((void*)back_buf, 0, sizeof(fbA));
+    memset((void*)back_buf, 0, FB_BYTES);
+}
+
+#if LED_PANEL_TRIPLE_BUFFER
+//
+// Mailbox: publishing swaps back <-> ready and never waits. If refresh has
+// not taken the previous ready frame yet, that stale frame becomes the new
+// back buffer and is dropped. Refresh swaps ready <-> front at the frame
+// boundary (take_ready_frame), so a frame is shown at most one frame late.
+//
+void swap_buffers(void) {
+    portENTER_CRITICAL(&fb_mux);
+    volatile pix_t (*tmp)[PHY_WIDTH] = ready_buf;
+    ready_buf = back_buf;
+    back_buf  = tmp;
+    uint8_t dropped = ready_fresh;
+    ready_fresh = 1;
+    portEXIT_CRITICAL(&fb_mux);
+
+    if (dropped) stats_frame_dropped();
+    stats_render_done();
 }
 
+static inline IRAM_ATTR void take_ready_frame(void)
+{
+    if (!ready_fresh) return;   // cheap unlocked check; the renderer only ever sets it
+
+    portENTER_CRITICAL_SAFE(&fb_mux);
+    volatile pix_t (*tmp)[PHY_WIDTH] = front_buf;
+    front_buf   = ready_buf;
+    ready_buf   = tmp;
+    ready_fresh = 0;
+    portEXIT_CRITICAL_SAFE(&fb_mux);
+}
+#else
 void swap_buffers(void) {
     // Instant pointer swap; no memcpy
     pix_t (*tmp)[PHY_WIDTH] = (pix_t (*)[PHY_WIDTH])front_buf;
     front_buf = back_buf;
     back_buf  = tmp;
+    stats_render_done();
 }
+#endif
+
+// ------------ Frame stream sink -------------
+static uint8_t *stream_frame_begin(void *ctx)
+{
+    // Streamed frames are never cleared first: time receive + decode instead
+    stats_render_start();
+    return (uint8_t *)back_buf;
+}
+
+static void stream_frame_done(void *ctx)
+{
+    swap_buffers();
+}
+
+void init_stream_decoder(frame_decoder_t *d, uint8_t *ref)
+{
+    frame_decoder_init(d, ref, PHY_HEIGHT * PHY_WIDTH);
+    d->out_copies  = FB_SUBFRAMES;
+    d->out_stride  = PHY_HEIGHT * PHY_WIDTH;
+    d->frame_begin = stream_frame_begin;
+    d->frame_done  = stream_frame_done;
+}
+
+#if LED_PANEL_STREAM_UART
+static uint8_t stream_ref[PHY_HEIGHT * PHY_WIDTH];
+static frame_decoder_t stream_dec;
+
+#if LED_PANEL_CAPTURE
+//
+// 'R' from the host: the decoder only signals stream_capture_task, which
+// waits for the capture and writes the reply (through the TX ring buffer),
+// so stream_rx_task keeps draining the RX ring while the host streams on.
+// Requests arriving during a capture collapse into one more reply.
+//
+static SemaphoreHandle_t capture_req;
+
+static void stream_capture_request(void *ctx)
+{
+    xSemaphoreGive(capture_req);
+}
+
+static void stream_capture_task(void *arg)
+{
+    uint8_t *buf = malloc(CAPTURE_MAX_BYTES);
+    if (!buf) {
+        ESP_LOGE(TAG, "stream: no memory for a %u byte capture buffer", (unsigned)CAPTURE_MAX_BYTES);
+        vTaskDelete(NULL);
+        return;
+    }
+    while (1) {
+        xSemaphoreTake(capture_req, portMAX_DELAY);
+        size_t n = capture_frame(buf, CAPTURE_MAX_BYTES, pdMS_TO_TICKS(100));
+        if (n) {
+            uart_write_bytes(STREAM_UART_NUM, buf, n);
+        } else {
+            ESP_LOGW(TAG, "stream: capture timed out");
+        }
+    }
+}
+#endif
+
+void stream_rx_task(void *arg)
+{
+    uart_config_t uart_conf = {
+        .baud_rate  = STREAM_UART_BAUD,
+        .data_bits  = UART_DATA_8_BITS,
+        .parity     = UART_PARITY_DISABLE,
+        .stop_bits  = UART_STOP_BITS_1,
+        .flow_ctrl  = UART_HW_FLOWCTRL_DISABLE,
+        .source_clk = UART_SCLK_DEFAULT,
+    };
+    ESP_ERROR_CHECK(uart_driver_install(STREAM_UART_NUM, STREAM_RX_BUF, STREAM_TX_BUF, 0, NULL, 0));
+    ESP_ERROR_CHECK(uart_param_config(STREAM_UART_NUM, &uart_conf));
+    ESP_ERROR_CHECK(uart_set_pin(STREAM_UART_NUM, STREAM_PIN_TX, STREAM_PIN_RX,
+                                 UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));
+
+    init_stream_decoder(&stream_dec, stream_ref);
+#if LED_PANEL_CAPTURE
+    // Below our priority and on our core, never next to refresh_task
+    capture_req = xSemaphoreCreateBinary();
+    if (!capture_req) ESP_ERROR_CHECK(ESP_ERR_NO_MEM);
+    xTaskCreatePinnedToCore(stream_capture_task, "Capture", 3072, NULL, 1, NULL, xPortGetCoreID());
+    stream_dec.capture_request = stream_capture_request;
+#endif
+
+    uint8_t buf[256];
+    uint32_t bad_seen = 0;
+    while (1) {
+        int n = uart_read_bytes(STREAM_UART_NUM, buf, sizeof(buf), pdMS_TO_TICKS(20));
+        if (n > 0) {
+            frame_decoder_feed(&stream_dec, buf, n);
+        }
+        if (stream_dec.frames_bad != bad_seen) {
+            bad_seen = stream_dec.frames_bad;
+            ESP_LOGW(TAG, "stream: bad frame (%lu ok, %lu bad, %lu skipped), waiting for keyframe",
+                     stream_dec.frames_ok, stream_dec.frames_bad, stream_dec.frames_skipped);
+        }
+    }
+}
+#endif
 
 // ------------ Virtual->Physical mapping set_pixel -------------
 //
@@ -194,10 +640,95 @@ static inline void set_pixel(int x, int y, int r, int g, int b) {
     if ((unsigned)phys_x >= (unsigned)PHY_WIDTH || (unsigned)phys_y >= (unsigned)PHY_HEIGHT) return;
 
     uint8_t v = (r ? 1 : 0) | (g ? 2 : 0) | (b ? 4 : 0);
-    back_buf[phys_y][phys_x] = v;
+    for (int k = 0; k < FB_SUBFRAMES; k++) {
+        back_buf[k * PHY_HEIGHT + phys_y][phys_x] = v;
+    }
 }
 
-// ------------ HUB75 refresh task (1/4 scan) -------------
+// ------------ RGB888 input: gamma + temporal dither -------------
+//
+// gamma_lut maps an 8-bit channel to the number of subframes it is lit in
+// (0..FB_SUBFRAMES). Which subframes: dither_mask[level][phase], bit k =
+// lit in subframe k. Lit subframes follow a bit-reversed order so they are
+// spread out in time (4 frames, level 2 -> frames 0 and 2), and a per-pixel
+// phase from a Bayer matrix offsets the ranks so neighbours flicker out of
+// step. The panel sees plain 3-bit frames; refresh just cycles them.
+//
+static uint8_t gamma_lut[256];
+static uint8_t dither_mask[FB_SUBFRAMES + 1][FB_SUBFRAMES];
+
+static const uint8_t bayer4[4][4] = {
+    {  0,  8,  2, 10 },
+    { 12,  4, 14,  6 },
+    {  3, 11,  1,  9 },
+    { 15,  7, 13,  5 },
+};
+
+static inline int dither_phase(int x, int y)
+{
+    // top log2(FB_SUBFRAMES) bits of the 4-bit Bayer value
+    return (bayer4[y & 3][x & 3] * FB_SUBFRAMES) >> 4;
+}
+
+static int bit_reverse(int v, int bits)
+{
+    int r = 0;
+    for (int i = 0; i < bits; i++) {
+        r = (r << 1) | ((v >> i) & 1);
+    }
+    return r;
+}
+
+static void init_dither_tables(void)
+{
+    const int bits = __builtin_ctz(FB_SUBFRAMES);
+
+    for (int v = 0; v < 256; v++) {
+        gamma_lut[v] = (uint8_t)lroundf(powf(v / 255.0f, LED_PANEL_GAMMA) * FB_SUBFRAMES);
+    }
+
+    for (int level = 0; level <= FB_SUBFRAMES; level++) {
+        for (int phase = 0; phase < FB_SUBFRAMES; phase++) {
+            uint8_t mask = 0;
+            for (int k = 0; k < FB_SUBFRAMES; k++) {
+                int rank = (bit_reverse(k, bits) + phase) % FB_SUBFRAMES;
+                if (rank < level) mask |= 1 << k;
+            }
+            dither_mask[level][phase] = mask;
+        }
+    }
+}
+
+void set_pixel_rgb888(int x, int y, uint8_t r, uint8_t g, uint8_t b)
+{
+    if ((unsigned)x >= (unsigned)VIRT_WIDTH || (unsigned)y >= (unsigned)VIRT_HEIGHT) return;
+
+    int phys_panel_idx = (y / PANEL_HEIGHT) * N_HOR + x / PANEL_WIDTH;
+    int phys_x = phys_panel_idx * PANEL_WIDTH + x % PANEL_WIDTH;
+    int phys_y = y % PANEL_HEIGHT;
+
+    int phase  = dither_phase(x, y);
+    uint8_t mr = dither_mask[gamma_lut[r]][phase];
+    uint8_t mg = dither_mask[gamma_lut[g]][phase];
+    uint8_t mb = dither_mask[gamma_lut[b]][phase];
+
+    for (int k = 0; k < FB_SUBFRAMES; k++) {
+        back_buf[k * PHY_HEIGHT + phys_y][phys_x] =
+            ((mr >> k) & 1) | (((mg >> k) & 1) << 1) | (((mb >> k) & 1) << 2);
+    }
+}
+
+void blit_rgb888(int x, int y, int w, int h, const uint8_t *rgb)
+{
+    for (int j = 0; j < h; j++) {
+        const uint8_t *p = rgb + (size_t)j * w * 3;
+        for (int i = 0; i < w; i++, p += 3) {
+            set_pixel_rgb888(x + i, y + j, p[0], p[1], p[2]);
+        }
+    }
+}
+
+// ------------ HUB75 refresh (1/4 scan) -------------
 //
 // Keeps your column-scanning logic pattern: total_cols = PANEL_WIDTH * PHYS_PANELS * 2
 // panel_index  = col / PANEL_WIDTH  -> 0..(2*PHYS_PANELS-1)
@@ -205,58 +736,457 @@ static inline void set_pixel(int x, int y, int r, int g, int b) {
 // y1 = (panel_index % 2) ? row : row + scan_rows
 // y2 = y1 + 2*scan_rows
 //
-void refresh_task(void *arg) {
-    const int scan_rows  = PANEL_HEIGHT / 4;              // e.g., 8 for 32px
+// Everything from here down to the pin helpers is IRAM_ATTR and only touches
+// DRAM (framebuffers, brightness, stats), so the same row routine can run
+// from the IRAM-safe timer ISR while the flash cache is disabled.
+//
+#define SCAN_ROWS   (PANEL_HEIGHT / 4)               // e.g., 8 for 32px
+
+// Dither subframe being scanned; the front buffer's subframes are shown
+// round-robin, one per refresh frame
+static DRAM_ATTR uint8_t subframe;
+#define SCAN_BUF()  (front_buf + subframe * PHY_HEIGHT)
+
+// A scan row reads 4 framebuffer lines: row + k*SCAN_ROWS, k = 0..3.
+// line[k] points at fb line row + k*SCAN_ROWS (or its prefetched copy).
+typedef const volatile pix_t *scan_lines_t[4];
+
+static inline IRAM_ATTR void get_scan_lines(volatile pix_t (*fb)[PHY_WIDTH], int row, scan_lines_t line)
+{
+    for (int k = 0; k < 4; k++) {
+        line[k] = fb[row + k * SCAN_ROWS];
+    }
+}
+
+#if LED_PANEL_CAPTURE
+//
+// Capture rides along with refresh: once armed, the next frame that starts
+// at subframe 0 is copied row by row as it is shifted out (from the same
+// scan lines, so no extra PSRAM reads), straight into virtual layout. The
+// caller is notified at the following frame boundary. Refresh never waits.
+//
+enum { CAP_IDLE, CAP_ARMED, CAP_ACTIVE, CAP_DONE };
+
+static DRAM_ATTR volatile uint8_t cap_state;
+static DRAM_ATTR portMUX_TYPE cap_mux = portMUX_INITIALIZER_UNLOCKED;
+static DRAM_ATTR TaskHandle_t cap_task;
+static uint8_t cap_virt[VIRT_HEIGHT][VIRT_WIDTH];
+#if LED_PANEL_REFRESH_ISR
+static DRAM_ATTR BaseType_t cap_woken;
+#endif
+
+// Every state change is a compare-and-set under cap_mux, from refresh (task
+// or ISR) and from capture_frame() alike, so neither can undo the other's
+static inline IRAM_ATTR bool cap_transition(uint8_t from, uint8_t to)
+{
+    portENTER_CRITICAL_SAFE(&cap_mux);
+    bool ok = cap_state == from;
+    if (ok) cap_state = to;
+    portEXIT_CRITICAL_SAFE(&cap_mux);
+    return ok;
+}
+
+// IDLE -> ARMED, taking ownership: cap_task only ever changes together with
+// a successful arm, so a caller turned away never redirects the notification
+static bool cap_arm(TaskHandle_t task)
+{
+    portENTER_CRITICAL_SAFE(&cap_mux);
+    bool ok = cap_state == CAP_IDLE;
+    if (ok) {
+        cap_state = CAP_ARMED;
+        cap_task = task;
+    }
+    portEXIT_CRITICAL_SAFE(&cap_mux);
+    return ok;
+}
+
+static inline IRAM_ATTR void capture_row(scan_lines_t line, int row)
+{
+    if (cap_state != CAP_ACTIVE) return;
+
+    // Physical panel p in the chain sits at (p % N_HOR, p / N_HOR) in the virtual grid
+    for (int k = 0; k < 4; k++) {
+        int y = row + k * SCAN_ROWS;
+        for (int p = 0; p < PHYS_PANELS; p++) {
+            uint8_t *dst = &cap_virt[(p / N_HOR) * PANEL_HEIGHT + y][(p % N_HOR) * PANEL_WIDTH];
+            const volatile pix_t *src = line[k] + p * PANEL_WIDTH;
+            for (int x = 0; x < PANEL_WIDTH; x++) {
+                dst[x] = src[x];
+            }
+        }
+    }
+}
+
+static inline IRAM_ATTR void capture_boundary(void)
+{
+    // Unlocked peeks keep the idle case to one load
+    if (cap_state == CAP_ACTIVE) {
+        if (!cap_transition(CAP_ACTIVE, CAP_DONE)) return;
+#if LED_PANEL_REFRESH_ISR
+        vTaskNotifyGiveFromISR(cap_task, &cap_woken);
+#else
+        xTaskNotifyGive(cap_task);
+#endif
+    } else if (cap_state == CAP_ARMED && subframe == 0) {
+        cap_transition(CAP_ARMED, CAP_ACTIVE);
+    }
+}
+
+size_t capture_frame(uint8_t *out, size_t cap, TickType_t timeout)
+{
+    static uint8_t seq;
+
+    ulTaskNotifyTake(pdTRUE, 0);             // drop a notification that raced a timeout
+    if (!cap_arm(xTaskGetCurrentTaskHandle())) return 0;   // another caller's capture is pending
+
+    if (ulTaskNotifyTake(pdTRUE, timeout) == 0) {
+        // From ARMED or ACTIVE; once IDLE, refresh leaves the state alone,
+        // so at most a notification already sent is left for the next call
+        portENTER_CRITICAL_SAFE(&cap_mux);
+        cap_state = CAP_IDLE;
+        portEXIT_CRITICAL_SAFE(&cap_mux);
+        return 0;
+    }
+    size_t n = stream_encode_capture(seq++, &cap_virt[0][0], VIRT_WIDTH, VIRT_HEIGHT, out, cap);
+    cap_transition(CAP_DONE, CAP_IDLE);
+    return n;
+}
+#else
+#define capture_row(line, row)  do { } while (0)
+#define capture_boundary()      do { } while (0)
+#endif
+
+// Between refresh frames: advance the dither subframe and, with triple
+// buffering, pick up the newest finished frame once all subframes were shown
+static inline IRAM_ATTR void frame_boundary(void)
+{
+    if (++subframe >= FB_SUBFRAMES) subframe = 0;
+#if LED_PANEL_TRIPLE_BUFFER
+    if (subframe == 0) take_ready_frame();
+#endif
+    capture_boundary();
+}
+
+// The register sequence of ledc_set_duty() + ledc_update_duty(), through the
+// header-inline LL calls: nothing here can end up in flash, whichever IDF
+// functions a given release keeps in IRAM. OE is a high-speed channel, so
+// there is no low-speed update latch to set. IDF 5.1 folded the separate
+// direction/num/cycle/scale setters into ledc_ll_set_fade_param().
+static inline IRAM_ATTR void oe_set_duty(uint32_t duty)
+{
+    ledc_dev_t *hw = LEDC_LL_GET_HW();
+    ledc_ll_set_duty_int_part(hw, OE_SPEED_MODE, OE_CHANNEL, duty);
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+    // dir, cycle, scale, step: one step straight to the new duty
+    ledc_ll_set_fade_param(hw, OE_SPEED_MODE, OE_CHANNEL, LEDC_DUTY_DIR_INCREASE, 1, 0, 1);
+#else
+    ledc_ll_set_duty_direction(hw, OE_SPEED_MODE, OE_CHANNEL, LEDC_DUTY_DIR_INCREASE);
+    ledc_ll_set_duty_num(hw, OE_SPEED_MODE, OE_CHANNEL, 1);
+    ledc_ll_set_duty_cycle(hw, OE_SPEED_MODE, OE_CHANNEL, 1);
+    ledc_ll_set_duty_scale(hw, OE_SPEED_MODE, OE_CHANNEL, 0);
+#endif
+    ledc_ll_set_sig_out_en(hw, OE_SPEED_MODE, OE_CHANNEL, true);
+    ledc_ll_set_duty_start(hw, OE_SPEED_MODE, OE_CHANNEL, true);
+}
+
+// Duty = 0 → PWM is always LOW → inverted OE stays HIGH → panel off
+static inline IRAM_ATTR void oe_blank(void)
+{
+    oe_set_duty(0);
+}
+
+// Same duty as update_oe_duty()
+static inline IRAM_ATTR void oe_show(void)
+{
+    const uint32_t max_duty = (1 << OE_DUTY_RES) - 1;
+    oe_set_duty((max_duty * global_brightness) / 255);
+}
+
+// Busy-wait the rest of a row's on-time
+static inline void wait_until(uint32_t start, uint32_t cycles)
+{
+    while (esp_cpu_get_cycle_count() - start < cycles) {
+    }
+}
+
+// One scan row: blank, address, shift both halves of every panel, latch, unblank.
+static IRAM_ATTR void refresh_row(scan_lines_t line, int row)
+{
     const int total_cols = PANEL_WIDTH * PHYS_PANELS * 2; // two halves (top/bottom)
 
-    while (1) {
-        for (int row = 0; row < scan_rows; row++) {
+    oe_blank();
+    set_row(row);
 
+    for (int col = 0; col < total_cols; col++) {
+        int panel_index    = col / PANEL_WIDTH;      // 0..(2*PHYS_PANELS-1)
+        int local_x        = col % PANEL_WIDTH;
+        int panel_in_chain = panel_index / 2;        // 0..(PHYS_PANELS-1)
+        int fb_x           = panel_in_chain * PANEL_WIDTH + local_x;
 
-                        //gpio_set_level(PIN_OE, 1);
-			// Duty = max → PWM is always HIGH → OE stays HIGH → panel off
-			ledc_set_duty(OE_SPEED_MODE, OE_CHANNEL, 0);
-			ledc_update_duty(OE_SPEED_MODE, OE_CHANNEL);
-            
-			//esp_rom_delay_us(5);
+        // Upper/lower half rows for this scan step:
+        // y1 = row (+ SCAN_ROWS on even panels), y2 = y1 + 2*SCAN_ROWS
+        int k1 = (panel_index % 2) ? 0 : 1;
 
-			set_row(row);
+        uint8_t p1 = line[k1][fb_x];
+        uint8_t p2 = line[k1 + 2][fb_x];
 
+        set_rgb_lines(p1, p2);
+        pulse_clk();
+    }
+    pulse_lat();
 
-            for (int col = 0; col < total_cols; col++) {
-                int panel_index    = col / PANEL_WIDTH;      // 0..(2*PHYS_PANELS-1)
-                int local_x        = col % PANEL_WIDTH;
-                int panel_in_chain = panel_index / 2;        // 0..(PHYS_PANELS-1)
-                int fb_x           = panel_in_chain * PANEL_WIDTH + local_x;
+    oe_show();
+}
+
+#if LED_PANEL_FB_PSRAM
+//
+// PSRAM reads are slow and bursty, so they are kept off the shift loop:
+// while row N is lit, the 4 lines of row N+1 are copied into an internal
+// line buffer, then the remaining on-time is busy-waited. Shift only ever
+// reads internal DRAM.
+//
+static pix_t line_buf[2][4][PHY_WIDTH];
 
-                // Upper/lower half rows for this scan step
-                int y1 = (panel_index % 2) ? row : row + scan_rows;
-                int y2 = y1 + 2 * scan_rows;
+static inline void prefetch_row(volatile pix_t (*fb)[PHY_WIDTH], int row, pix_t dst[4][PHY_WIDTH])
+{
+    for (int k = 0; k < 4; k++) {
+        memcpy(dst[k], (const void *)fb[row + k * SCAN_ROWS], PHY_WIDTH * sizeof(pix_t));
+    }
+}
 
-                uint8_t p1 = 0, p2 = 0;
-                if ((unsigned)fb_x < (unsigned)PHY_WIDTH) {
-                    if ((unsigned)y1 < (unsigned)PHY_HEIGHT) p1 = front_buf[y1][fb_x];
-                    if ((unsigned)y2 < (unsigned)PHY_HEIGHT) p2 = front_buf[y2][fb_x];
-                }
+void refresh_task(void *arg) {
+    const uint32_t on_cycles = ROW_ON_US * esp_rom_get_cpu_ticks_per_us();
+    int cur = 0;
+    scan_lines_t line;
 
-				set_rgb_lines(p1, p2);
-				pulse_clk();
+    stats_refresh_start();
+    prefetch_row(SCAN_BUF(), 0, line_buf[cur]);
 
-            }
-			pulse_lat();
+    while (1) {
+        for (int row = 0; row < SCAN_ROWS; row++) {
+            uint32_t t_shift = STATS_NOW();
+            for (int k = 0; k < 4; k++) line[k] = line_buf[cur][k];
+            refresh_row(line, row);
+            uint32_t t_on = esp_cpu_get_cycle_count();
+            capture_row(line, row);
+
+            // Next row (or row 0 of whatever is front by then) while this one is lit
+            int next = (row + 1 < SCAN_ROWS) ? row + 1 : 0;
+            if (next == 0) frame_boundary();
+            cur ^= 1;
+            prefetch_row(SCAN_BUF(), next, line_buf[cur]);
+            wait_until(t_on, on_cycles);
+
+            stats_row_done(t_shift, t_on, STATS_NOW());
+        }
+        stats_frame_done(STATS_NOW());
+    }
+}
+
+// Sustained refresh timing, internal vs PSRAM placement. Scans the current
+// front buffer for `frames` frames per variant with full row timing and logs
+// us per row; run before refresh starts (it owns the panel pins meanwhile).
+// The PSRAM runs scan every subframe of every framebuffer in turn and walk
+// an eviction block between frames, so each frame starts with a cold cache,
+// as on a wall whose buffers are far bigger than the 32 KB flash/PSRAM cache.
+#define BENCH_EVICT_BYTES  (64 * 1024)
+#define BENCH_CACHE_LINE   32
+
+static void bench_evict_cache(const volatile uint8_t *evict)
+{
+    for (size_t i = 0; i < BENCH_EVICT_BYTES; i += BENCH_CACHE_LINE) {
+        (void)evict[i];
+    }
+}
+
+static pix_t (*bench_frame(int frame))[PHY_WIDTH]
+{
+#if LED_PANEL_TRIPLE_BUFFER
+    pix_t (*fb[])[PHY_WIDTH] = { fbA, fbB, fbC };
+#else
+    pix_t (*fb[])[PHY_WIDTH] = { fbA, fbB };
+#endif
+    const int n = sizeof(fb) / sizeof(fb[0]);
+    return fb[frame % n] + ((frame / n) % FB_SUBFRAMES) * PHY_HEIGHT;
+}
+
+void run_fb_placement_bench(int frames)
+{
+    const uint32_t tpu = esp_rom_get_cpu_ticks_per_us();
+    const uint32_t on_cycles = ROW_ON_US * tpu;
+    const int rows = frames * SCAN_ROWS;
+
+    const size_t frame_bytes = PHY_HEIGHT * PHY_WIDTH * sizeof(pix_t);
+    pix_t (*internal)[PHY_WIDTH] = heap_caps_malloc(frame_bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    uint8_t *evict = heap_caps_malloc(BENCH_EVICT_BYTES, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!internal || !evict) {
+        ESP_LOGW(TAG, "bench: no memory for a %u byte copy + %u byte eviction block",
+                 (unsigned)frame_bytes, (unsigned)BENCH_EVICT_BYTES);
+        heap_caps_free(internal);
+        heap_caps_free(evict);
+        return;
+    }
+    memcpy(internal, (const void *)SCAN_BUF(), frame_bytes);
+
+    scan_lines_t line;
+    uint32_t shift_int = 0, shift_psram = 0, shift_pf = 0, fetch_pf = 0, fetch_max = 0;
+
+    // 1) internal DRAM, direct
+    for (int i = 0; i < rows; i++) {
+        int row = i % SCAN_ROWS;
+        get_scan_lines(internal, row, line);
+        uint32_t t0 = esp_cpu_get_cycle_count();
+        refresh_row(line, row);
+        uint32_t t1 = esp_cpu_get_cycle_count();
+        shift_int += t1 - t0;
+        wait_until(t1, on_cycles);
+    }
+
+    // 2) PSRAM, direct: shift loop waits on PSRAM/cache misses
+    for (int f = 0; f < frames; f++) {
+        pix_t (*fb)[PHY_WIDTH] = bench_frame(f);
+        bench_evict_cache(evict);
+        for (int row = 0; row < SCAN_ROWS; row++) {
+            get_scan_lines(fb, row, line);
+            uint32_t t0 = esp_cpu_get_cycle_count();
+            refresh_row(line, row);
+            uint32_t t1 = esp_cpu_get_cycle_count();
+            shift_psram += t1 - t0;
+            wait_until(t1, on_cycles);
+        }
+    }
+
+    // 3) PSRAM with line-buffer prefetch (what refresh_task does)
+    int cur = 0;
+    for (int f = 0; f < frames; f++) {
+        pix_t (*fb)[PHY_WIDTH] = bench_frame(f);
+        bench_evict_cache(evict);
+        prefetch_row(fb, 0, line_buf[cur]);
+        for (int row = 0; row < SCAN_ROWS; row++) {
+            for (int k = 0; k < 4; k++) line[k] = line_buf[cur][k];
+            uint32_t t0 = esp_cpu_get_cycle_count();
+            refresh_row(line, row);
+            uint32_t t1 = esp_cpu_get_cycle_count();
+            cur ^= 1;
+            if (row + 1 < SCAN_ROWS) prefetch_row(fb, row + 1, line_buf[cur]);
+            uint32_t t2 = esp_cpu_get_cycle_count();
+            shift_pf += t1 - t0;
+            fetch_pf += t2 - t1;
+            if (t2 - t1 > fetch_max) fetch_max = t2 - t1;
+            wait_until(t1, on_cycles);
+        }
+    }
+    oe_blank();
+    heap_caps_free(internal);
+    heap_caps_free(evict);
+
+    uint32_t div = (uint32_t)rows * tpu;
+    ESP_LOGI(TAG, "bench %d frames, shift us/row: internal %lu, psram direct %lu, psram prefetched %lu",
+             frames, shift_int / div, shift_psram / div, shift_pf / div);
+    ESP_LOGI(TAG, "bench prefetch us/row: avg %lu, max %lu (on-time budget %d)",
+             fetch_pf / div, fetch_max / tpu, ROW_ON_US);
+}
 
-            //gpio_set_level(PIN_OE, 0);
-			// Duty = 0 → PWM is always LOW → OE stays LOW → panel on
-			//ledc_set_duty(OE_SPEED_MODE, OE_CHANNEL, (1 << OE_DUTY_RES) - 1);
-			//ledc_update_duty(OE_SPEED_MODE, OE_CHANNEL);
-			update_oe_duty();
+#else
+
+void refresh_task(void *arg) {
+    const uint32_t on_cycles = ROW_ON_US * esp_rom_get_cpu_ticks_per_us();
+    scan_lines_t line;
 
+    stats_refresh_start();
 
-            // Visible time per row; tune for brightness/ghosting
-            esp_rom_delay_us(50);
+    while (1) {
+        for (int row = 0; row < SCAN_ROWS; row++) {
+            uint32_t t_shift = STATS_NOW();
+            get_scan_lines(SCAN_BUF(), row, line);
+            refresh_row(line, row);
+            uint32_t t_on = esp_cpu_get_cycle_count();
+
+            // Visible time per row (ROW_ON_US); a capture copy runs inside it
+            capture_row(line, row);
+            wait_until(t_on, on_cycles);
+            stats_row_done(t_shift, t_on, STATS_NOW());
         }
+        frame_boundary();
+        stats_frame_done(STATS_NOW());
+    }
+}
+#endif
+
+#if LED_PANEL_REFRESH_ISR
+//
+// Timer-driven refresh: one scan row per alarm. Each alarm is one-shot and
+// re-armed ROW_ON_US after the row was latched, so the on-time matches
+// refresh_task and does not shrink as the chain (shift time) grows; the ISR
+// can never fire back to back and starve its core. The gptimer ISR, this
+// callback and the gptimer calls in it all live in IRAM, so refresh keeps
+// running through NVS writes, OTA and partition erases.
+//
+static gptimer_handle_t refresh_timer;
+
+static IRAM_ATTR bool refresh_alarm_cb(gptimer_handle_t timer,
+                                       const gptimer_alarm_event_data_t *edata, void *ctx)
+{
+    static DRAM_ATTR int row;
+    static DRAM_ATTR uint32_t t_shift, t_on;
+
+    uint32_t now = STATS_NOW();
+    if (t_on) stats_row_done(t_shift, t_on, now);
+
+    scan_lines_t line;
+    get_scan_lines(SCAN_BUF(), row, line);
+    t_shift = now;
+    refresh_row(line, row);
+    t_on = STATS_NOW();
+
+    // Next row after ROW_ON_US of on-time; everything below runs inside it
+    uint64_t count;
+    gptimer_get_raw_count(timer, &count);
+    gptimer_alarm_config_t next = { .alarm_count = count + ROW_ON_US };
+    gptimer_set_alarm_action(timer, &next);
+
+    capture_row(line, row);
+
+    if (++row >= SCAN_ROWS) {
+        row = 0;
+        frame_boundary();
+        stats_frame_done(t_on);
     }
+#if LED_PANEL_CAPTURE
+    BaseType_t woken = cap_woken;
+    cap_woken = pdFALSE;
+    return woken == pdTRUE;   // capture_frame() caller woken
+#else
+    return false;   // no task woken
+#endif
+}
+
+void start_refresh_isr(void)
+{
+    gptimer_config_t timer_conf = {
+        .clk_src       = GPTIMER_CLK_SRC_DEFAULT,
+        .direction     = GPTIMER_COUNT_UP,
+        .resolution_hz = 1000000,                // 1 tick = 1 us
+    };
+    ESP_ERROR_CHECK(gptimer_new_timer(&timer_conf, &refresh_timer));
+
+    gptimer_event_callbacks_t cbs = {
+        .on_alarm = refresh_alarm_cb,
+    };
+    // Interrupt is allocated on the calling core
+    ESP_ERROR_CHECK(gptimer_register_event_callbacks(refresh_timer, &cbs, NULL));
+
+    // One-shot; refresh_alarm_cb re-arms it for each row
+    gptimer_alarm_config_t alarm_conf = {
+        .alarm_count = ROW_ON_US,
+    };
+    ESP_ERROR_CHECK(gptimer_set_alarm_action(refresh_timer, &alarm_conf));
+
+    stats_refresh_start();
+    ESP_ERROR_CHECK(gptimer_enable(refresh_timer));
+    ESP_ERROR_CHECK(gptimer_start(refresh_timer));
 }
+#endif
 
 
 // Renders a 3x5 glyph scaled to 20x40 by x6,y8 with 1px left/right margins.
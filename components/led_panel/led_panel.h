@@ -2,13 +2,18 @@
 #include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "frame_stream.h"
 
 
 // ------------ CONFIG: panel + layout ------------
 #define PANEL_WIDTH    64
 #define PANEL_HEIGHT   32    // must be divisible by 4 (1/4 scan)
+#ifndef N_HOR
 #define N_HOR          3     // logical panels horizontally
+#endif
+#ifndef N_VER
 #define N_VER          2     // logical panels vertically
+#endif
 
 // Virtual drawing size (what you use in set_pixel)
 #define VIRT_WIDTH   (PANEL_WIDTH  * N_HOR)
@@ -36,6 +41,49 @@
 //-------------------------------------------//-------------------------------------------
 
 
+// ------------ UART frame stream (protocol in frame_stream.h) ------------
+// 1: stream_rx_task decodes keyframes / deltas from a host controller
+//    straight into the back buffer and swaps when a frame is complete
+#ifndef LED_PANEL_STREAM_UART
+#define LED_PANEL_STREAM_UART  0
+#endif
+#define STREAM_UART_NUM        UART_NUM_2
+#define STREAM_UART_BAUD       921600
+#define STREAM_PIN_RX          GPIO_NUM_32
+#define STREAM_PIN_TX          GPIO_NUM_33
+#define STREAM_RX_BUF          4096  // driver ring buffer, bytes
+#define STREAM_TX_BUF          2048  // capture replies; must exceed the 128 byte FIFO
+
+// A worst-case (all literal) keyframe must fit the 16-bit payload length
+#define STREAM_FRAME_FITS      (STREAM_RLE_MAX(PHY_WIDTH * PHY_HEIGHT) <= 0xFFFF)
+#if LED_PANEL_STREAM_UART && !STREAM_FRAME_FITS
+#error "LED_PANEL_STREAM_UART: PHY_WIDTH x PHY_HEIGHT frames do not fit one stream frame"
+#endif
+
+// ------------ Framebuffer capture ------------
+// capture_frame() returns what refresh actually scanned (one full frame,
+// copied row by row as it is shifted out, no stall) in VIRT_WIDTH x
+// VIRT_HEIGHT layout, RLE-encoded as a STREAM_CAPTURE frame. Costs one
+// VIRT_WIDTH * VIRT_HEIGHT byte buffer in internal DRAM, so it is only on
+// by default where something asks for captures (the UART 'R' request).
+#ifndef LED_PANEL_CAPTURE
+#define LED_PANEL_CAPTURE      LED_PANEL_STREAM_UART
+#endif
+#define CAPTURE_MAX_BYTES      (STREAM_HEADER_LEN + 4 + STREAM_RLE_MAX(VIRT_WIDTH * VIRT_HEIGHT) + STREAM_CRC_LEN)
+#if LED_PANEL_CAPTURE && 4 + STREAM_RLE_MAX(VIRT_WIDTH * VIRT_HEIGHT) > 0xFFFF
+#error "LED_PANEL_CAPTURE: VIRT_WIDTH x VIRT_HEIGHT captures do not fit one stream frame"
+#endif
+
+// ------------ Refresh mode ------------
+// 0: refresh_task (FreeRTOS task, stalls while the flash cache is disabled)
+// 1: start_refresh_isr() drives one scan row per IRAM-safe gptimer alarm, so
+//    the wall stays lit during NVS writes / OTA. Needs the IRAM options set in
+//    sdkconfig.defaults.
+#ifndef LED_PANEL_REFRESH_ISR
+#define LED_PANEL_REFRESH_ISR  0
+#endif
+#define ROW_ON_US              50    // visible time per scan row (both modes); tune for brightness/ghosting
+
 // Choose a high-speed channel/timer so duty updates are as fast as possible
 #define OE_SPEED_MODE    LEDC_HIGH_SPEED_MODE
 #define OE_TIMER_NUM     LEDC_TIMER_0
@@ -47,12 +95,49 @@
 // Packed RGB: bit0=R, bit1=G, bit2=B
 typedef uint8_t pix_t;
 
-// Two physical-layout framebuffers: [y][x] = 32 x (64*PHYS_PANELS)
-static pix_t fbA[PHY_HEIGHT][PHY_WIDTH];
-static pix_t fbB[PHY_HEIGHT][PHY_WIDTH];
-
-static volatile pix_t (*front_buf)[PHY_WIDTH] = fbA; // scanned by refresh task
-static volatile pix_t (*back_buf)[PHY_WIDTH]  = fbB; // drawn by your code
+// Temporal dithering: each framebuffer holds FB_SUBFRAMES physical frames
+// stacked along y; refresh shows subframe 0, 1, ... on successive frames.
+// RGB888 input is gamma-corrected to 0..FB_SUBFRAMES lit subframes per
+// channel. 1 = off (one frame, RGB888 input is thresholded); else 2, 4 or 8.
+// Buffers grow with it (3x2 wall: 12 KB per subframe per buffer), so 4 and 8
+// generally need LED_PANEL_FB_PSRAM; see LED_PANEL_FB_INTERNAL_MAX.
+#ifndef LED_PANEL_DITHER_FRAMES
+#define LED_PANEL_DITHER_FRAMES 1
+#endif
+#define FB_SUBFRAMES   LED_PANEL_DITHER_FRAMES
+#define LED_PANEL_GAMMA 2.2f
+
+// 0: fbA/fbB, swap_buffers() flips front/back immediately (may tear)
+// 1: adds fbC as a mailbox: swap_buffers() never waits, refresh takes the
+//    newest finished frame at the frame boundary, stale frames are dropped
+#ifndef LED_PANEL_TRIPLE_BUFFER
+#define LED_PANEL_TRIPLE_BUFFER 0
+#endif
+
+// Two (three) physical-layout framebuffers: [sub*y][x] = FB_SUBFRAMES*32 x (64*PHYS_PANELS),
+// owned by led_panel.c (front scanned by refresh, back drawn by your code)
+#define FB_BYTES       (FB_SUBFRAMES * PHY_HEIGHT * PHY_WIDTH * sizeof(pix_t))
+
+// 0: fbA/fbB are static arrays in internal DRAM
+// 1: fbA/fbB are allocated in external PSRAM by init_framebuffers(); refresh
+//    prefetches the next scan row into an internal line buffer during the
+//    current row's on-time. Needs CONFIG_SPIRAM and the task refresh mode.
+#ifndef LED_PANEL_FB_PSRAM
+#define LED_PANEL_FB_PSRAM     0
+#endif
+
+// Without PSRAM: build fails if all framebuffers together exceed this much
+// internal .bss (WiFi and the rest of the app need the remainder)
+#ifndef LED_PANEL_FB_INTERNAL_MAX
+#define LED_PANEL_FB_INTERNAL_MAX  (64 * 1024)
+#endif
+
+// With LED_PANEL_FB_PSRAM: app_main runs run_fb_placement_bench() for this
+// many frames before starting refresh (internal vs PSRAM shift timing, log
+// only). 0 = off.
+#ifndef LED_PANEL_FB_BENCH
+#define LED_PANEL_FB_BENCH     0
+#endif
 
 typedef struct {
     const char *text;   // text to scroll (can include '\n' for multiple lines)
@@ -64,16 +149,79 @@ typedef struct {
 } scroll_text_t;
 
 void init_pins(void);
+void init_framebuffers(void);           // allocate (PSRAM mode) and clear fbA/fbB
 void init_oe_pwm(void);
 void set_global_brightness(uint8_t level);
 void refresh_task(void *arg);
+#if LED_PANEL_REFRESH_ISR
+void start_refresh_isr(void);           // call from the core that should take the interrupt
+#endif
+#if LED_PANEL_FB_PSRAM
+void run_fb_placement_bench(int frames); // before refresh starts; drives the panel pins
+#endif
 void clear_back_buffer(void);
 void swap_buffers(void);
 void draw_text_20x40(int x, int y, const char *s, int r, int g, int b);
+
+// Point a frame stream decoder at the panel: pixels go to back_buf (every
+// dither subframe), each complete frame is published with swap_buffers().
+// ref must hold PHY_HEIGHT * PHY_WIDTH bytes.
+void init_stream_decoder(frame_decoder_t *d, uint8_t *ref);
+#if LED_PANEL_STREAM_UART
+void stream_rx_task(void *arg);         // 'R' capture requests are answered from a
+                                        // task it starts on the same core
+#endif
+
+#if LED_PANEL_CAPTURE
+// Blocks until the next full frame is scanned (about two frame times).
+// Uses the calling task's notification. One caller at a time (0 if another
+// capture is pending). Returns bytes written to out, 0 on timeout or if
+// cap < CAPTURE_MAX_BYTES and the frame does not fit.
+size_t capture_frame(uint8_t *out, size_t cap, TickType_t timeout);
+#endif
+
+// 8-bit per channel input, gamma-corrected and dithered over FB_SUBFRAMES
+void set_pixel_rgb888(int x, int y, uint8_t r, uint8_t g, uint8_t b);
+// Copy a w x h packed RGB888 image (3 bytes/pixel, row-major) to virtual (x, y)
+void blit_rgb888(int x, int y, int w, int h, const uint8_t *rgb);
 //void scroll_text_update(scroll_text_t *scroll);
 
 void scroll_text_20x40(const char *text, int y, int r, int g, int b, int speed_ms);
 
+// ------------ Runtime stats (refresh + render telemetry) -------------
+// Cycle-counter based, cheap enough to leave on. Set LED_PANEL_STATS to 0
+// to compile every counter and the API below out completely.
+#ifndef LED_PANEL_STATS
+#define LED_PANEL_STATS        1
+#endif
+#define STATS_LOG_PERIOD_MS    5000  // panel_stats_task dump interval
+#define RENDER_HIST_BINS       8     // bin 0: <128us, bin i: <(128us << i), last bin open-ended
+
+#if LED_PANEL_STATS
+typedef struct {
+    uint32_t frames;                    // refresh frames since boot
+    uint32_t swaps;                     // swap_buffers() calls since boot
+    uint32_t drops;                     // triple buffering: frames replaced before shown
+    uint32_t fps;                       // refresh frames in the last full second
+    uint32_t swaps_per_sec;             // swaps in the last full second
+    uint32_t shift_us_last;             // per row: blank + shift + latch + unblank
+    uint32_t shift_us_max;              //   worst case over the last second
+    uint32_t on_us_last;                // per row: visible time
+    uint32_t on_us_max;                 //   worst case over the last second
+    uint32_t frame_us_min;              // frame period over the last second;
+    uint32_t frame_us_max;              //   jitter = max - min
+    uint32_t render_hist[RENDER_HIST_BINS]; // clear_back_buffer() -> swap_buffers() time;
+                                        //   streamed frames: decode start -> swap
+    uint32_t refresh_stack_free;        // stack high-water marks (bytes never used);
+                                        // refresh is 0 with LED_PANEL_REFRESH_ISR
+    uint32_t render_stack_free;
+} panel_stats_t;
+
+void get_panel_stats(panel_stats_t *out);
+void log_panel_stats(void);
+void panel_stats_task(void *arg);       // logs every STATS_LOG_PERIOD_MS
+#endif
+
 
 
 
@@ -37,14 +37,29 @@ void app_main(void)
 	init_oe_pwm();
 	set_global_brightness(255); //0 - 255
 
-    // Clear both buffers first time
-    memset((void*)fbA, 0, sizeof(fbA));
-    memset((void*)fbB, 0, sizeof(fbB));
-
+    // Allocate (PSRAM mode) and clear both buffers first time
+    init_framebuffers();
+#if LED_PANEL_FB_PSRAM && LED_PANEL_FB_BENCH
+	run_fb_placement_bench(LED_PANEL_FB_BENCH);   // internal vs PSRAM refresh timing
+#endif
+
+#if LED_PANEL_REFRESH_ISR
+    // Start timer-driven refresh; app_main runs on core 0, so the ISR lands there
+	start_refresh_isr();
+#else
     // Start refresh task (pin-driving) on core 0
 	xTaskCreatePinnedToCore(refresh_task, "refresh_task", 2048, NULL, 1, NULL, 0);
+#endif
 
+#if LED_PANEL_STREAM_UART
+	// Content comes from the host controller instead of drawing_task
+	xTaskCreatePinnedToCore(stream_rx_task,       "Stream",  4096, NULL, 2, NULL, 1);
+#else
 	xTaskCreatePinnedToCore(drawing_task,         "Draw",    4096, NULL, 1, NULL, 1);
+#endif
+#if LED_PANEL_STATS
+	xTaskCreatePinnedToCore(panel_stats_task,     "Stats",   2048, NULL, 1, NULL, 1);
+#endif
 	//xTaskCreatePinnedToCore(background_task,      "BG",      1024, NULL, 1, NULL, 1);
 
 
@@ -0,0 +1,268 @@
+// Host-side rendering benchmark + golden-image check for led_panel.c
+//
+// Builds the real drawing code for Linux against the stubs in ./stubs and
+// times it; one binary per N_HOR x N_VER layout (see Makefile):
+//
+//   make              build all layouts, run, compare against golden/
+//   make update-golden  rewrite golden/ from the current renderer
+//
+// Usage: bench_render <golden.txt> [--update]
+//
+// After each scene fbA and fbB are compared pixel by pixel against the
+// stored frames, so a renderer change can be shown to be both faster and
+// pixel-identical. Exit status is non-zero on any mismatch.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "led_panel.c"
+
+#define BENCH_CLEARS   20000
+#define BENCH_TEXT_REP 200
+
+static const char *BENCH_TEXT =
+    "HELLO WORLD 0123456789\n"
+    "abcdefghijklmnopqrstuvwxyz\n"
+    ".,:;!?-+/\\ ABCDEFGHIJKLM";
+
+static const char *SCROLL_TEXT = "HELLO! 1 2 3 4 5 6 7 8 9 0";
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// ------------ Golden frames -------------
+//
+// Text format, one section per scene/buffer:
+//   # <scene> <fbA|fbB> <PHY_WIDTH>x<FB_ROWS>
+//   FB_ROWS lines of PHY_WIDTH digits '0'..'7' (packed RGB value)
+// FB_ROWS covers every dither subframe, subframe 0 first.
+//
+#define FB_ROWS (FB_SUBFRAMES * PHY_HEIGHT)
+
+static FILE *golden_in;
+static FILE *golden_out;
+static int   mismatches;
+
+static void write_frame(const char *scene, const char *name, pix_t fb[FB_ROWS][PHY_WIDTH])
+{
+    fprintf(golden_out, "# %s %s %dx%d\n", scene, name, PHY_WIDTH, FB_ROWS);
+    for (int y = 0; y < FB_ROWS; y++) {
+        for (int x = 0; x < PHY_WIDTH; x++) {
+            fputc('0' + (fb[y][x] & 0x07), golden_out);
+        }
+        fputc('\n', golden_out);
+    }
+}
+
+static void check_frame(const char *scene, const char *name, pix_t fb[FB_ROWS][PHY_WIDTH])
+{
+    char header[128], expect[128];
+    static char line[PHY_WIDTH + 2];
+
+    snprintf(expect, sizeof(expect), "# %s %s %dx%d\n", scene, name, PHY_WIDTH, FB_ROWS);
+    if (!fgets(header, sizeof(header), golden_in) || strcmp(header, expect) != 0) {
+        printf("  %s/%s: golden section missing or layout differs\n", scene, name);
+        mismatches++;
+        return;
+    }
+
+    int bad = 0;
+    for (int y = 0; y < FB_ROWS; y++) {
+        if (!fgets(line, sizeof(line), golden_in)) {
+            printf("  %s/%s: golden truncated at row %d\n", scene, name, y);
+            mismatches++;
+            return;
+        }
+        for (int x = 0; x < PHY_WIDTH; x++) {
+            if ((line[x] - '0') != (fb[y][x] & 0x07)) {
+                if (bad == 0) {
+                    printf("  %s/%s: first mismatch at phys (%d,%d): got %d, want %c\n",
+                           scene, name, x, y, fb[y][x] & 0x07, line[x]);
+                }
+                bad++;
+            }
+        }
+    }
+    if (bad) {
+        printf("  %s/%s: %d pixels differ\n", scene, name, bad);
+        mismatches++;
+    }
+}
+
+static void verify_scene(const char *scene)
+{
+    if (golden_out) {
+        write_frame(scene, "fbA", fbA);
+        write_frame(scene, "fbB", fbB);
+    } else if (golden_in) {
+        check_frame(scene, "fbA", fbA);
+        check_frame(scene, "fbB", fbB);
+    }
+}
+
+// ------------ Scenes -------------
+static void bench_clear(void)
+{
+    double t0 = now_ns();
+    for (int i = 0; i < BENCH_CLEARS; i++) {
+        clear_back_buffer();
+    }
+    double t1 = now_ns();
+    printf("  clear_back_buffer  %10.1f ns/clear\n", (t1 - t0) / BENCH_CLEARS);
+
+    swap_buffers();
+    clear_back_buffer();
+    verify_scene("clear");
+}
+
+static void bench_text(void)
+{
+    int glyphs = 0;
+    for (const char *p = BENCH_TEXT; *p; p++) {
+        if (*p != '\n') glyphs++;
+    }
+
+    double t0 = now_ns();
+    for (int i = 0; i < BENCH_TEXT_REP; i++) {
+        draw_text_20x40(2, 0, BENCH_TEXT, 1, 1, 0);
+    }
+    double t1 = now_ns();
+    printf("  draw_text_20x40    %10.1f ns/glyph\n", (t1 - t0) / ((double)BENCH_TEXT_REP * glyphs));
+
+    // Deterministic content in both buffers
+    clear_back_buffer();
+    draw_text_20x40(2, 0, BENCH_TEXT, 1, 0, 1);
+    swap_buffers();
+    clear_back_buffer();
+    draw_text_20x40(-7, 13, "0123456789 xyz", 0, 1, 1);
+    set_pixel(VIRT_WIDTH - 1, VIRT_HEIGHT - 1, 1, 1, 1);
+    verify_scene("text");
+}
+
+static void bench_scroll(void)
+{
+    int frames = VIRT_WIDTH + (int)strlen(SCROLL_TEXT) * 20;
+
+    double t0 = now_ns();
+    scroll_text_20x40(SCROLL_TEXT, 10, 0, 1, 0, 20);
+    double t1 = now_ns();
+    printf("  scroll_text_20x40  %10.1f ns/frame (%d frames)\n", (t1 - t0) / frames, frames);
+
+    // The last two scroll frames are left in fbA/fbB
+    verify_scene("scroll");
+}
+
+// Every channel value must be lit in exactly gamma_lut[v] subframes, at
+// every Bayer phase: fill the wall with all 256 levels per channel and count
+static void check_gamma_coverage(void)
+{
+    clear_back_buffer();
+    for (int y = 0; y < VIRT_HEIGHT; y++) {
+        for (int x = 0; x < VIRT_WIDTH; x++) {
+            int v = x + y * 7;
+            set_pixel_rgb888(x, y, v & 0xFF, (v * 3 + 85) & 0xFF, (255 - v) & 0xFF);
+        }
+    }
+
+    int bad = 0;
+    for (int y = 0; y < VIRT_HEIGHT; y++) {
+        for (int x = 0; x < VIRT_WIDTH; x++) {
+            int v = x + y * 7;
+            const uint8_t in[3] = { v & 0xFF, (v * 3 + 85) & 0xFF, (255 - v) & 0xFF };
+            int phys_x = ((y / PANEL_HEIGHT) * N_HOR + x / PANEL_WIDTH) * PANEL_WIDTH + x % PANEL_WIDTH;
+            int phys_y = y % PANEL_HEIGHT;
+
+            for (int c = 0; c < 3; c++) {
+                int lit = 0;
+                for (int k = 0; k < FB_SUBFRAMES; k++) {
+                    lit += (back_buf[k * PHY_HEIGHT + phys_y][phys_x] >> c) & 1;
+                }
+                if (lit != gamma_lut[in[c]]) {
+                    if (bad == 0) {
+                        printf("  rgb888: virt (%d,%d) channel %d value %d lit in %d subframes, want %d\n",
+                               x, y, c, in[c], lit, gamma_lut[in[c]]);
+                    }
+                    bad++;
+                }
+            }
+        }
+    }
+    if (bad) {
+        printf("  rgb888: %d channels with wrong subframe count\n", bad);
+        mismatches++;
+    }
+}
+
+static void bench_rgb888(void)
+{
+    static uint8_t img[VIRT_HEIGHT][VIRT_WIDTH][3];
+    for (int y = 0; y < VIRT_HEIGHT; y++) {
+        for (int x = 0; x < VIRT_WIDTH; x++) {
+            img[y][x][0] = (uint8_t)(x * 255 / (VIRT_WIDTH - 1));
+            img[y][x][1] = (uint8_t)(y * 255 / (VIRT_HEIGHT - 1));
+            img[y][x][2] = (uint8_t)((x + y) * 4);
+        }
+    }
+
+    check_gamma_coverage();   // the blit below overwrites the whole back buffer
+
+    const int reps = 200;
+    double t0 = now_ns();
+    for (int i = 0; i < reps; i++) {
+        blit_rgb888(0, 0, VIRT_WIDTH, VIRT_HEIGHT, &img[0][0][0]);
+    }
+    double t1 = now_ns();
+    printf("  blit_rgb888        %10.1f ns/pixel\n",
+           (t1 - t0) / ((double)reps * VIRT_WIDTH * VIRT_HEIGHT));
+
+    swap_buffers();
+    clear_back_buffer();
+    set_pixel_rgb888(0, 0, 255, 128, 0);
+    verify_scene("rgb888");
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <golden.txt> [--update]\n", argv[0]);
+        return 2;
+    }
+    int update = argc > 2 && strcmp(argv[2], "--update") == 0;
+
+    if (update) {
+        golden_out = fopen(argv[1], "w");
+        if (!golden_out) { perror(argv[1]); return 2; }
+    } else {
+        golden_in = fopen(argv[1], "r");
+        if (!golden_in) { perror(argv[1]); return 2; }
+    }
+
+    printf("layout %dx%d panels, virt %dx%d, phys %dx%d\n",
+           N_HOR, N_VER, VIRT_WIDTH, VIRT_HEIGHT, PHY_WIDTH, PHY_HEIGHT);
+
+    init_framebuffers();
+
+    bench_clear();
+    bench_text();
+    bench_scroll();
+    bench_rgb888();
+
+#if LED_PANEL_STATS
+    log_panel_stats();   // render side only: refresh does not run on the host
+#endif
+
+    if (golden_out) {
+        fclose(golden_out);
+        printf("  golden written to %s\n", argv[1]);
+        return 0;
+    }
+    fclose(golden_in);
+    printf("  golden: %s\n", mismatches ? "MISMATCH" : "pixel-identical");
+    return mismatches ? 1 : 0;
+}
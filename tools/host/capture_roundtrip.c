@@ -0,0 +1,205 @@
+// Framebuffer capture round trip (no hardware)
+//
+// Random content is drawn through set_pixel and captured with
+// capture_frame(); while it waits for its notification the refresh scan is
+// replayed row by row the way refresh_task does it. The capture is decoded
+// again and compared with the image that was drawn, in virtual layout.
+// Timeouts, a stale notification and a second caller are checked against
+// the capture state and the notification tallies. Also checks that an 'R'
+// frame reaches the decoder's capture_request hook.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "led_panel.c"
+
+#define VIRT_PIXELS (VIRT_WIDTH * VIRT_HEIGHT)
+
+static uint8_t drawn[VIRT_HEIGHT][VIRT_WIDTH];
+static uint8_t decoded[VIRT_PIXELS];
+static uint8_t wire[CAPTURE_MAX_BYTES];
+static int failures;
+
+// One refresh frame, as refresh_task runs it
+static void scan_frame(void)
+{
+    scan_lines_t line;
+    for (int row = 0; row < SCAN_ROWS; row++) {
+        get_scan_lines(SCAN_BUF(), row, line);
+        capture_row(line, row);
+    }
+    frame_boundary();
+}
+
+static void draw_random(unsigned seed)
+{
+    srand(seed);
+    clear_back_buffer();
+    for (int y = 0; y < VIRT_HEIGHT; y++) {
+        for (int x = 0; x < VIRT_WIDTH; x++) {
+            // Mostly runs with some noise, like real content
+            uint8_t v = (rand() % 8 == 0) ? rand() & 7 : ((x / 16 + y / 8) & 7);
+            drawn[y][x] = v;
+            set_pixel(x, y, v & 1, v & 2, v & 4);
+        }
+    }
+    swap_buffers();
+}
+
+// Worst case from arming: finish the current frame, scan one whole frame
+#define CAPTURE_TICKS (2 * FB_SUBFRAMES)
+
+static bool settled(const char *what, uint32_t gives, uint32_t takes)
+{
+    host_task_t *t = &host_main_task;
+    if (cap_state != CAP_IDLE || cap_task != t || t->notify != 0 ||
+        t->gives != gives || t->takes != takes) {
+        printf("  %s: state %d, task %s, %lu pending, %lu gives, %lu takes (want %lu / %lu)\n",
+               what, cap_state, cap_task == t ? "ok" : "wrong", (unsigned long)t->notify,
+               (unsigned long)t->gives, (unsigned long)t->takes,
+               (unsigned long)gives, (unsigned long)takes);
+        failures++;
+        return false;
+    }
+    return true;
+}
+
+static void check_capture(const char *what)
+{
+    uint32_t gives = host_main_task.gives, takes = host_main_task.takes;
+    host_notify_wait = scan_frame;
+    size_t n = capture_frame(wire, sizeof(wire), CAPTURE_TICKS);
+    host_notify_wait = NULL;
+    if (n == 0) {
+        printf("  %s: capture did not complete\n", what);
+        failures++;
+        return;
+    }
+    if (!settled(what, gives + 1, takes + 1)) return;
+
+    const size_t hdr = STREAM_HEADER_LEN + 4;
+    size_t len = n ? wire[4] | (wire[5] << 8) : 0;
+    uint16_t crc = n ? stream_crc16(0xFFFF, wire + 2, STREAM_HEADER_LEN - 2 + len) : 0;
+    if (n == 0 || wire[2] != STREAM_CAPTURE ||
+        (wire[n - 2] | (wire[n - 1] << 8)) != crc ||
+        (wire[6] | (wire[7] << 8)) != VIRT_WIDTH || (wire[8] | (wire[9] << 8)) != VIRT_HEIGHT ||
+        !stream_rle_decode(wire + hdr, n - hdr - STREAM_CRC_LEN, decoded, VIRT_PIXELS)) {
+        printf("  %s: capture frame malformed\n", what);
+        failures++;
+        return;
+    }
+    if (memcmp(decoded, drawn, VIRT_PIXELS) != 0) {
+        for (int i = 0; i < VIRT_PIXELS; i++) {
+            if (decoded[i] != (&drawn[0][0])[i]) {
+                printf("  %s: first mismatch at virt (%d,%d): got %d, want %d\n", what,
+                       i % VIRT_WIDTH, i / VIRT_WIDTH, decoded[i], (&drawn[0][0])[i]);
+                break;
+            }
+        }
+        failures++;
+        return;
+    }
+    printf("  %s: %d pixels -> %zu bytes\n", what, VIRT_PIXELS, n);
+}
+
+// Second caller shows up while the first one waits
+static host_task_t other_task;
+static size_t other_result = 1;
+
+static void scan_with_intruder(void)
+{
+    host_current_task = &other_task;
+    other_result = capture_frame(wire, sizeof(wire), CAPTURE_TICKS);
+    host_current_task = &host_main_task;
+    host_notify_wait = scan_frame;
+    scan_frame();
+}
+
+static void check_waits(void)
+{
+    host_task_t *t = &host_main_task;
+    uint32_t gives = t->gives, takes = t->takes;
+
+    // Nothing scanned: times out while armed
+    if (capture_frame(wire, sizeof(wire), 0) != 0) {
+        printf("  timeout armed: returned a capture\n");
+        failures++;
+    }
+    settled("timeout armed", gives, takes);
+
+    // Times out mid-frame; refresh must drop the capture, not notify later
+    host_notify_wait = scan_frame;
+    size_t n = capture_frame(wire, sizeof(wire), 1);
+    host_notify_wait = NULL;
+    for (int f = 0; f < CAPTURE_TICKS; f++) {
+        scan_frame();
+    }
+    if (n != 0) {
+        printf("  timeout active: returned a capture\n");
+        failures++;
+    }
+    settled("timeout active", gives, takes);
+
+    // A notification left over from a lost race must not satisfy the next wait
+    t->notify = 1;
+    n = capture_frame(wire, sizeof(wire), 0);
+    if (n != 0) {
+        printf("  stale notification: returned a capture\n");
+        failures++;
+    }
+    settled("stale notification", gives, takes + 1);
+
+    // The first caller keeps the capture and its notification
+    host_notify_wait = scan_with_intruder;
+    n = capture_frame(wire, sizeof(wire), CAPTURE_TICKS);
+    host_notify_wait = NULL;
+    if (n == 0 || other_result != 0 || other_task.gives || other_task.notify) {
+        printf("  second caller: first got %zu bytes, second %zu, second notified %lu\n",
+               n, other_result, (unsigned long)other_task.gives);
+        failures++;
+    }
+    settled("second caller", gives + 1, takes + 2);
+}
+
+static int requests;
+static void on_request(void *ctx) { requests++; }
+
+int main(void)
+{
+    printf("layout %dx%d panels, virt %dx%d\n", N_HOR, N_VER, VIRT_WIDTH, VIRT_HEIGHT);
+    init_framebuffers();
+
+    draw_random(1);
+    check_capture("random");
+
+    // Armed mid-stream: must still pick up a whole frame
+    draw_random(2);
+    scan_frame();
+    check_capture("after scan");
+
+    // Blank wall compresses to a handful of bytes
+    memset(drawn, 0, sizeof(drawn));
+    clear_back_buffer();
+    swap_buffers();
+    check_capture("blank");
+
+    check_waits();
+
+    static uint8_t ref[PHY_HEIGHT * PHY_WIDTH];
+    frame_decoder_t dec;
+    init_stream_decoder(&dec, ref);
+    dec.capture_request = on_request;
+    const uint8_t req[] = { STREAM_SYNC0, STREAM_SYNC1, STREAM_CAPTURE_REQ, 0, 0, 0 };
+    uint16_t crc = stream_crc16(0xFFFF, req + 2, sizeof(req) - 2);
+    const uint8_t tail[] = { crc & 0xFF, crc >> 8 };
+    frame_decoder_feed(&dec, req, sizeof(req));
+    frame_decoder_feed(&dec, tail, sizeof(tail));
+    if (requests != 1 || dec.frames_bad) {
+        printf("  capture request not delivered\n");
+        failures++;
+    }
+
+    printf("  capture round trip: %s\n", failures ? "FAILED" : "ok");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,267 @@
+// Host-side capture decoder: sign framebuffer capture -> PNG
+//
+// Reads one 'C' capture frame (protocol in components/led_panel/frame_stream.h)
+// from a file written off the UART, or with -r asks the sign for one over the
+// serial port first, checks its CRC and writes the virtual-layout image as an
+// RGB PNG, each LED as a scale x scale block. Pixels are the raw 3-bit values
+// refresh scanned (subframe 0 with dithering), so diff against the expected
+// content rendered the same way.
+//
+// Usage: capture_to_png [-s scale] [-b baud] [-r] <capture.bin|tty> <out.png>
+//
+// The image size comes from the frame, so one build serves every layout.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <poll.h>
+
+#include "led_panel.h"
+#include "host_tty.h"
+
+// ------------ Capture frame input -------------
+static int read_byte(int fd, int timeout_ms)
+{
+    uint8_t b;
+    if (timeout_ms >= 0) {
+        struct pollfd p = { .fd = fd, .events = POLLIN };
+        if (poll(&p, 1, timeout_ms) <= 0) return -1;
+    }
+    return read(fd, &b, 1) == 1 ? b : -1;
+}
+
+// Scans for the next capture frame with a good CRC; returns payload length
+// (payload in buf), -1 at end of input or timeout
+static long read_capture(int fd, int timeout_ms, uint8_t *buf, size_t cap)
+{
+    for (;;) {
+        int c = read_byte(fd, timeout_ms);
+        if (c < 0) return -1;
+        if (c != STREAM_SYNC0) continue;
+        if ((c = read_byte(fd, timeout_ms)) < 0) return -1;
+        if (c != STREAM_SYNC1) continue;
+
+        uint8_t hdr[4];
+        for (int i = 0; i < 4; i++) {
+            if ((c = read_byte(fd, timeout_ms)) < 0) return -1;
+            hdr[i] = (uint8_t)c;
+        }
+        size_t len = hdr[2] | (hdr[3] << 8);
+        if (hdr[0] != STREAM_CAPTURE || len < 4 || len + STREAM_CRC_LEN > cap) continue;
+
+        for (size_t i = 0; i < len + STREAM_CRC_LEN; i++) {
+            if ((c = read_byte(fd, timeout_ms)) < 0) return -1;
+            buf[i] = (uint8_t)c;
+        }
+        uint16_t crc = stream_crc16(stream_crc16(0xFFFF, hdr, 4), buf, len);
+        if ((buf[len] | (buf[len + 1] << 8)) != crc) {
+            fprintf(stderr, "capture frame with bad CRC, skipped\n");
+            continue;
+        }
+        return (long)len;
+    }
+}
+
+static int request_capture(const char *path, long baud)
+{
+    int fd = open(path, O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+    struct termios tio;
+    speed_t sp = baud_to_speed(baud);
+    if (tcgetattr(fd, &tio) < 0 || !sp) {
+        fprintf(stderr, "%s: not a tty or unsupported baud %ld\n", path, baud);
+        close(fd);
+        return -1;
+    }
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, sp);
+    cfsetospeed(&tio, sp);
+    tcsetattr(fd, TCSANOW, &tio);
+    tcflush(fd, TCIFLUSH);
+
+    uint8_t req[STREAM_HEADER_LEN + STREAM_CRC_LEN] = {
+        STREAM_SYNC0, STREAM_SYNC1, STREAM_CAPTURE_REQ, 0, 0, 0
+    };
+    uint16_t crc = stream_crc16(0xFFFF, req + 2, STREAM_HEADER_LEN - 2);
+    req[STREAM_HEADER_LEN]     = crc & 0xFF;
+    req[STREAM_HEADER_LEN + 1] = crc >> 8;
+    if (write(fd, req, sizeof(req)) != (ssize_t)sizeof(req)) {
+        perror("write");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// ------------ Minimal PNG writer (stored deflate, no zlib) -------------
+static uint32_t crc32_update(uint32_t crc, const uint8_t *p, size_t n)
+{
+    crc = ~crc;
+    while (n--) {
+        crc ^= *p++;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+        }
+    }
+    return ~crc;
+}
+
+static void put_be32(uint8_t *p, uint32_t v)
+{
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+static void write_chunk(FILE *f, const char *type, const uint8_t *data, size_t len)
+{
+    uint8_t b[4];
+    put_be32(b, (uint32_t)len);
+    fwrite(b, 1, 4, f);
+    fwrite(type, 1, 4, f);
+    if (len) fwrite(data, 1, len, f);
+    uint32_t crc = crc32_update(crc32_update(0, (const uint8_t *)type, 4), data, len);
+    put_be32(b, crc);
+    fwrite(b, 1, 4, f);
+}
+
+static int write_png(const char *path, const uint8_t *pix, int w, int h, int scale)
+{
+    const size_t W = (size_t)w * scale, H = (size_t)h * scale;
+    const size_t stride = 1 + W * 3;   // filter byte + RGB
+    const size_t raw_len = stride * H;
+    const size_t blocks = (raw_len + 65534) / 65535;
+
+    uint8_t *raw = malloc(raw_len);
+    uint8_t *z   = malloc(2 + raw_len + blocks * 5 + 4);
+    if (!raw || !z) {
+        free(raw);
+        free(z);
+        return -1;
+    }
+
+    for (size_t y = 0; y < H; y++) {
+        uint8_t *row = raw + y * stride;
+        *row++ = 0;   // filter: none
+        for (size_t x = 0; x < W; x++) {
+            uint8_t v = pix[(y / scale) * w + x / scale];
+            *row++ = (v & 1) ? 255 : 0;
+            *row++ = (v & 2) ? 255 : 0;
+            *row++ = (v & 4) ? 255 : 0;
+        }
+    }
+
+    // zlib stream of stored blocks
+    size_t o = 0;
+    uint32_t a = 1, b = 0;
+    z[o++] = 0x78;
+    z[o++] = 0x01;
+    for (size_t i = 0; i < raw_len; i += 65535) {
+        size_t n = raw_len - i < 65535 ? raw_len - i : 65535;
+        z[o++] = (i + n == raw_len);   // BFINAL, BTYPE=00
+        z[o++] = n & 0xFF;
+        z[o++] = n >> 8;
+        z[o++] = ~n & 0xFF;
+        z[o++] = (~n >> 8) & 0xFF;
+        memcpy(z + o, raw + i, n);
+        o += n;
+    }
+    for (size_t i = 0; i < raw_len; i++) {
+        a = (a + raw[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    put_be32(z + o, (b << 16) | a);
+    o += 4;
+
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        perror(path);
+        free(raw);
+        free(z);
+        return -1;
+    }
+    static const uint8_t sig[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    uint8_t ihdr[13];
+    put_be32(ihdr, (uint32_t)W);
+    put_be32(ihdr + 4, (uint32_t)H);
+    ihdr[8]  = 8;   // bit depth
+    ihdr[9]  = 2;   // colour type: RGB
+    ihdr[10] = 0;
+    ihdr[11] = 0;
+    ihdr[12] = 0;
+
+    fwrite(sig, 1, sizeof(sig), f);
+    write_chunk(f, "IHDR", ihdr, sizeof(ihdr));
+    write_chunk(f, "IDAT", z, o);
+    write_chunk(f, "IEND", NULL, 0);
+
+    int err = ferror(f);
+    fclose(f);
+    free(raw);
+    free(z);
+    return err ? -1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    int  scale   = 4;
+    long baud    = STREAM_UART_BAUD;
+    int  request = 0;
+    int  opt;
+
+    while ((opt = getopt(argc, argv, "s:b:r")) != -1) {
+        switch (opt) {
+        case 's': scale   = atoi(optarg); break;
+        case 'b': baud    = atol(optarg); break;
+        case 'r': request = 1; break;
+        default:  goto usage;
+        }
+    }
+    if (argc - optind != 2 || scale < 1 || scale > 64) goto usage;
+
+    const char *in = argv[optind];
+    int fd = request ? request_capture(in, baud)
+                     : (strcmp(in, "-") == 0 ? STDIN_FILENO : open(in, O_RDONLY));
+    if (fd < 0) {
+        if (!request) perror(in);
+        return 1;
+    }
+
+    static uint8_t payload[0x10000 + STREAM_CRC_LEN];
+    long len = read_capture(fd, request ? 2000 : -1, payload, sizeof(payload));
+    if (len < 0) {
+        fprintf(stderr, "%s: no valid capture frame\n", in);
+        return 1;
+    }
+
+    int w = payload[0] | (payload[1] << 8);
+    int h = payload[2] | (payload[3] << 8);
+    uint8_t *pix = malloc((size_t)w * h);
+    if (!pix || w == 0 || h == 0 || !stream_rle_decode(payload + 4, (size_t)len - 4, pix, (size_t)w * h)) {
+        fprintf(stderr, "%s: capture payload malformed\n", in);
+        return 1;
+    }
+    if (w != VIRT_WIDTH || h != VIRT_HEIGHT) {
+        fprintf(stderr, "note: capture is %dx%d, this build expects %dx%d\n",
+                w, h, VIRT_WIDTH, VIRT_HEIGHT);
+    }
+
+    if (write_png(argv[optind + 1], pix, w, h, scale) < 0) {
+        fprintf(stderr, "%s: write failed\n", argv[optind + 1]);
+        return 1;
+    }
+    fprintf(stderr, "%dx%d capture, %ld byte payload -> %s\n", w, h, len, argv[optind + 1]);
+    free(pix);
+    return 0;
+
+usage:
+    fprintf(stderr, "usage: %s [-s scale] [-b baud] [-r] <capture.bin|tty> <out.png>\n", argv[0]);
+    return 2;
+}
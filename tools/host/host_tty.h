@@ -0,0 +1,17 @@
+#pragma once
+// Serial port helpers shared by the host tools that talk to the ESP32
+#include <termios.h>
+
+// termios speed for a baud rate the ESP32 UART runs at, 0 if unsupported
+static inline speed_t baud_to_speed(long baud)
+{
+    switch (baud) {
+    case 115200:  return B115200;
+    case 230400:  return B230400;
+    case 460800:  return B460800;
+    case 921600:  return B921600;
+    case 1000000: return B1000000;
+    case 2000000: return B2000000;
+    default:      return 0;
+    }
+}
@@ -0,0 +1,116 @@
+// Triple-buffer mailbox test (LED_PANEL_TRIPLE_BUFFER, no hardware)
+//
+// Drives swap_buffers() (renderer side) and frame_boundary() (refresh side)
+// in a fixed and then a random interleaving, against a model of the
+// mailbox: refresh always picks up the newest published frame at its next
+// subframe-0 boundary, every frame overwritten before that counts as a
+// drop, and front, ready and back are always three different buffers.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "led_panel.c"
+
+#if !LED_PANEL_TRIPLE_BUFFER || !LED_PANEL_STATS
+#error "build with -DLED_PANEL_TRIPLE_BUFFER=1 -DLED_PANEL_STATS=1"
+#endif
+
+static int failures;
+static int next_id = 1;
+
+// Frame id drawn into pixel (0,0) of every subframe
+static int frame_id(volatile pix_t (*fb)[PHY_WIDTH])
+{
+    return fb[0][0];
+}
+
+static void check_buffers(const char *what)
+{
+    if (front_buf == back_buf || front_buf == ready_buf || back_buf == ready_buf) {
+        printf("  %s: renderer and refresh share a buffer\n", what);
+        failures++;
+    }
+}
+
+static int render_and_publish(void)
+{
+    int id = next_id++;
+    clear_back_buffer();
+    for (int k = 0; k < FB_SUBFRAMES; k++) {
+        back_buf[k * PHY_HEIGHT][0] = (pix_t)id;
+    }
+    swap_buffers();
+    check_buffers("swap");
+    return id;
+}
+
+static void refresh_frame(void)
+{
+    frame_boundary();
+    check_buffers("frame boundary");
+}
+
+static void expect(int cond, const char *what)
+{
+    if (!cond) {
+        printf("  %s\n", what);
+        failures++;
+    }
+}
+
+int main(void)
+{
+    init_framebuffers();
+    check_buffers("init");
+
+    // Three frames published while refresh is mid-frame: the newest wins,
+    // the two before it are dropped
+    int shown = frame_id(front_buf);
+    render_and_publish();
+    render_and_publish();
+    int newest = render_and_publish();
+    expect(stats.drops == 2, "drops not counted for overwritten frames");
+    expect(frame_id(front_buf) == shown, "front changed before the frame boundary");
+
+    // Not picked up until all dither subframes of the current frame were shown
+    for (int k = 1; k < FB_SUBFRAMES; k++) {
+        refresh_frame();
+        expect(frame_id(front_buf) == shown, "front changed mid dither cycle");
+    }
+    refresh_frame();
+    expect(frame_id(front_buf) == newest, "newest frame not shown at the boundary");
+
+    // Nothing fresh: front stays, nothing dropped
+    refresh_frame();
+    expect(frame_id(front_buf) == newest, "front changed without a new frame");
+    expect(stats.drops == 2, "drop counted without a publish");
+
+    // Random interleaving against the model
+    srand(1);
+    uint32_t drops = stats.drops;
+    int pending = 0;          // newest published id not yet taken, 0 if none
+    shown = newest;
+    for (int i = 0; i < 20000 && !failures; i++) {
+        if (rand() % 3 == 0) {
+            if (pending) drops++;
+            pending = render_and_publish();
+        } else {
+            int boundary = (subframe + 1) % FB_SUBFRAMES == 0;
+            refresh_frame();
+            if (boundary && pending) {
+                shown   = pending;
+                pending = 0;
+            }
+        }
+        if (frame_id(front_buf) != shown || stats.drops != drops) {
+            printf("  step %d: front shows %d (want %d), drops %lu (want %lu)\n", i,
+                   frame_id(front_buf), shown, (unsigned long)stats.drops, (unsigned long)drops);
+            failures++;
+        }
+        if (next_id > 200) next_id = 1;   // ids fit in a pix_t
+    }
+
+    printf("  mailbox: %s\n", failures ? "FAILED" : "ok");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,124 @@
+// Host-side frame stream encoder (protocol in components/led_panel/frame_stream.h)
+//
+// Reads raw physical frames (PHY_HEIGHT x PHY_WIDTH bytes each, packed RGB
+// 0..7, same layout as fbA/fbB) and sends them as a keyframe followed by
+// XOR deltas, with a keyframe every N frames so a sign that missed bytes
+// recovers.
+//
+// Usage: stream_encode [-k keyint] [-b baud] [-f fps] <frames.raw> <tty|->
+//
+// Built per layout like bench_render; the layout must match the firmware.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <time.h>
+
+#include "led_panel.h"
+#include "host_tty.h"
+
+#define FRAME_PIXELS (PHY_HEIGHT * PHY_WIDTH)
+#define WIRE_MAX     (STREAM_HEADER_LEN + STREAM_RLE_MAX(FRAME_PIXELS) + STREAM_CRC_LEN)
+
+#if !STREAM_FRAME_FITS
+#error "PHY_WIDTH x PHY_HEIGHT frames do not fit the 16-bit stream payload length"
+#endif
+
+static int open_tty(const char *path, long baud)
+{
+    int fd = open(path, O_WRONLY | O_NOCTTY);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+
+    struct termios tio;
+    if (tcgetattr(fd, &tio) == 0) {   // not a tty (file, pipe): write as-is
+        speed_t sp = baud_to_speed(baud);
+        if (!sp) {
+            fprintf(stderr, "unsupported baud %ld\n", baud);
+            close(fd);
+            return -1;
+        }
+        cfmakeraw(&tio);
+        cfsetispeed(&tio, sp);
+        cfsetospeed(&tio, sp);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    return fd;
+}
+
+static int write_all(int fd, const uint8_t *p, size_t n)
+{
+    while (n) {
+        ssize_t w = write(fd, p, n);
+        if (w < 0) return -1;
+        p += w;
+        n -= (size_t)w;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int  keyint = 30;
+    long baud   = STREAM_UART_BAUD;
+    int  fps    = 0;   // 0: as fast as the link takes it
+    int  opt;
+
+    while ((opt = getopt(argc, argv, "k:b:f:")) != -1) {
+        switch (opt) {
+        case 'k': keyint = atoi(optarg); break;
+        case 'b': baud   = atol(optarg); break;
+        case 'f': fps    = atoi(optarg); break;
+        default:  goto usage;
+        }
+    }
+    if (argc - optind != 2 || keyint < 1) goto usage;
+
+    FILE *in = fopen(argv[optind], "rb");
+    if (!in) {
+        perror(argv[optind]);
+        return 1;
+    }
+    int fd = strcmp(argv[optind + 1], "-") == 0 ? STDOUT_FILENO : open_tty(argv[optind + 1], baud);
+    if (fd < 0) return 1;
+
+    static uint8_t cur[FRAME_PIXELS], prev[FRAME_PIXELS], wire[WIRE_MAX];
+    unsigned frames = 0;
+    size_t raw_bytes = 0, wire_bytes = 0;
+
+    while (fread(cur, 1, FRAME_PIXELS, in) == FRAME_PIXELS) {
+        uint8_t type = (frames % keyint == 0) ? STREAM_KEYFRAME : STREAM_DELTA;
+        size_t n = stream_encode_frame(type, (uint8_t)frames, cur, prev, FRAME_PIXELS,
+                                       wire, sizeof(wire));
+        if (n == 0) {
+            fprintf(stderr, "frame %u: encoded payload does not fit one stream frame\n", frames);
+            return 1;
+        }
+        if (write_all(fd, wire, n) < 0) {
+            perror("write");
+            return 1;
+        }
+        memcpy(prev, cur, FRAME_PIXELS);
+        frames++;
+        raw_bytes  += FRAME_PIXELS;
+        wire_bytes += n;
+
+        if (fps > 0) {
+            struct timespec ts = { 0, 1000000000L / fps };
+            nanosleep(&ts, NULL);
+        }
+    }
+
+    fprintf(stderr, "%u frames, %zu -> %zu bytes (%.1f%%)\n", frames, raw_bytes, wire_bytes,
+            raw_bytes ? 100.0 * wire_bytes / raw_bytes : 0.0);
+    return 0;
+
+usage:
+    fprintf(stderr, "usage: %s [-k keyint] [-b baud] [-f fps] <frames.raw> <tty|->\n", argv[0]);
+    return 2;
+}
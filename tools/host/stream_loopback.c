@@ -0,0 +1,198 @@
+// Frame stream loopback test over a pseudo-terminal (no hardware)
+//
+// A child process renders scroll frames with the real drawing code, encodes
+// them (keyframe every KEYINT frames) and writes them to the PTY master.
+// The parent reads the slave side in small chunks, feeds the decoder wired
+// to the panel exactly as stream_rx_task does, and checks every swapped
+// front buffer against the expected frame. One frame is corrupted on the
+// wire to check that deltas are dropped until the next keyframe.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pty.h>
+#include <termios.h>
+#include <sys/wait.h>
+
+#include "led_panel.c"
+
+#define FRAME_PIXELS (PHY_HEIGHT * PHY_WIDTH)
+#define WIRE_MAX     (STREAM_HEADER_LEN + STREAM_RLE_MAX(FRAME_PIXELS) + STREAM_CRC_LEN)
+#define N_FRAMES     48
+#define KEYINT       16
+#define CORRUPT      5      // frame whose payload gets a flipped bit
+
+static uint8_t expected[N_FRAMES][FRAME_PIXELS];
+
+static void render_frames(void)
+{
+    for (int f = 0; f < N_FRAMES; f++) {
+        clear_back_buffer();
+        draw_text_20x40(VIRT_WIDTH - f * 7, 10, "HELLO 123", 1, f & 1, 0);
+        draw_text_20x40(0, 0, f < N_FRAMES / 2 ? "AB" : "CD", 0, 0, 1);
+        memcpy(expected[f], (const void *)back_buf, FRAME_PIXELS);
+    }
+}
+
+static void sender(int fd)
+{
+    static uint8_t wire[WIRE_MAX];
+    size_t raw = 0, sent = 0;
+
+    for (int f = 0; f < N_FRAMES; f++) {
+        uint8_t type = (f % KEYINT == 0) ? STREAM_KEYFRAME : STREAM_DELTA;
+        size_t n = stream_encode_frame(type, (uint8_t)f, expected[f], f ? expected[f - 1] : NULL,
+                                       FRAME_PIXELS, wire, sizeof(wire));
+        if (n == 0) _exit(3);
+        if (f == CORRUPT) wire[n / 2] ^= 0x10;
+
+        for (size_t o = 0; o < n;) {
+            ssize_t w = write(fd, wire + o, n - o);
+            if (w < 0) _exit(4);
+            o += (size_t)w;
+        }
+        raw  += FRAME_PIXELS;
+        sent += n;
+    }
+    fprintf(stderr, "  sent %d frames, %zu -> %zu bytes (%.1f%%)\n", N_FRAMES, raw, sent,
+            100.0 * sent / raw);
+    // Let the reader drain before the master closes
+    tcdrain(fd);
+    usleep(300 * 1000);
+    _exit(0);
+}
+
+// ------------ Receiver side -------------
+static int shown[N_FRAMES];
+static int failures;
+static frame_decoder_t dec;
+
+static void (*panel_frame_done)(void *ctx);
+
+// Runs in place of the panel's frame_done: swap, let refresh run one full
+// dither cycle (with triple buffering that is when the frame is picked up),
+// then check what is shown
+static void check_front(void *ctx)
+{
+    panel_frame_done(ctx);
+    for (int k = 0; k < FB_SUBFRAMES; k++) {
+        frame_boundary();
+    }
+
+    int f = dec.seq;
+    if (f >= N_FRAMES || memcmp((const void *)front_buf, expected[f], FRAME_PIXELS) != 0) {
+        printf("  frame %d: front buffer differs from the sent frame\n", f);
+        failures++;
+        return;
+    }
+    for (int k = 1; k < FB_SUBFRAMES; k++) {
+        if (memcmp((const void *)(front_buf + k * PHY_HEIGHT), expected[f], FRAME_PIXELS) != 0) {
+            printf("  frame %d: subframe %d not written\n", f, k);
+            failures++;
+        }
+    }
+    shown[f] = 1;
+}
+
+// Bad frames that never reach ref (corrupt 'R', stray 'C', unknown type)
+// are counted but must not force a resync: a delta right after still applies
+static void check_non_frame_errors(void)
+{
+    static uint8_t ref[FRAME_PIXELS], wire[WIRE_MAX];
+    frame_decoder_t d;
+    frame_decoder_init(&d, ref, FRAME_PIXELS);
+
+    size_t n = stream_encode_frame(STREAM_KEYFRAME, 0, expected[0], NULL, FRAME_PIXELS, wire, sizeof(wire));
+    frame_decoder_feed(&d, wire, n);
+
+    uint8_t junk[STREAM_HEADER_LEN + STREAM_CRC_LEN] = { STREAM_SYNC0, STREAM_SYNC1, STREAM_CAPTURE_REQ };
+    frame_decoder_feed(&d, junk, sizeof(junk));                 // 'R' with a bad CRC
+    junk[2] = STREAM_CAPTURE;
+    frame_decoder_feed(&d, junk, sizeof(junk));                 // 'C' never goes to the sign
+    junk[2] = 'Z';
+    frame_decoder_feed(&d, junk, sizeof(junk));                 // unknown type
+
+    n = stream_encode_frame(STREAM_DELTA, 1, expected[1], expected[0], FRAME_PIXELS, wire, sizeof(wire));
+    frame_decoder_feed(&d, wire, n);
+
+    if (d.frames_ok != 2 || d.frames_bad != 3 || d.frames_skipped != 0 ||
+        memcmp(ref, expected[1], FRAME_PIXELS) != 0) {
+        printf("  non-frame errors: %lu ok, %lu bad, %lu skipped (want 2 / 3 / 0)\n",
+               (unsigned long)d.frames_ok, (unsigned long)d.frames_bad,
+               (unsigned long)d.frames_skipped);
+        failures++;
+    }
+}
+
+int main(void)
+{
+    init_framebuffers();
+    render_frames();
+    check_non_frame_errors();
+
+    int master, slave;
+    if (openpty(&master, &slave, NULL, NULL, NULL) < 0) {
+        perror("openpty");
+        return 2;
+    }
+    struct termios tio;
+    tcgetattr(slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(slave);
+        sender(master);
+    }
+    close(master);
+
+    static uint8_t ref[FRAME_PIXELS];
+    init_stream_decoder(&dec, ref);
+    panel_frame_done = dec.frame_done;
+    dec.frame_done   = check_front;
+
+    uint8_t buf[97];   // odd chunk size: frames straddle reads
+    for (;;) {
+        ssize_t n = read(slave, buf, sizeof(buf));
+        if (n <= 0) break;   // EIO once the sender has exited
+        frame_decoder_feed(&dec, buf, (size_t)n);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+
+    // Expected: the corrupted frame is bad, the deltas after it up to the
+    // next keyframe are skipped, everything else is shown pixel-exact
+    int want_skipped = KEYINT - 1 - CORRUPT;
+    int want_ok      = N_FRAMES - 1 - want_skipped;
+    for (int f = 0; f < N_FRAMES; f++) {
+        int lost = f >= CORRUPT && f < KEYINT;
+        if (shown[f] == lost) {
+            printf("  frame %d: %s\n", f, lost ? "shown but should have been dropped" : "missing");
+            failures++;
+        }
+    }
+
+    printf("  decoder: %lu ok, %lu bad, %lu skipped (want %d / 1 / %d)\n",
+           (unsigned long)dec.frames_ok, (unsigned long)dec.frames_bad,
+           (unsigned long)dec.frames_skipped, want_ok, want_skipped);
+    if (dec.frames_ok != (uint32_t)want_ok || dec.frames_bad != 1 ||
+        dec.frames_skipped != (uint32_t)want_skipped || !WIFEXITED(status) || WEXITSTATUS(status)) {
+        failures++;
+    }
+
+#if LED_PANEL_STATS
+    // Every shown frame lands in the render histogram (decode start -> swap)
+    uint32_t timed = 0;
+    for (int b = 0; b < RENDER_HIST_BINS; b++) timed += stats.render_hist[b];
+    if (timed != dec.frames_ok) {
+        printf("  render histogram holds %lu frames, want %lu\n",
+               (unsigned long)timed, (unsigned long)dec.frames_ok);
+        failures++;
+    }
+#endif
+
+    printf("  stream loopback: %s\n", failures ? "FAILED" : "ok");
+    return failures ? 1 : 0;
+}
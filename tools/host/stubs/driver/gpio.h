@@ -0,0 +1,24 @@
+#pragma once
+// Host stub: pin numbers and no-op configuration calls.
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef enum {
+    GPIO_NUM_2 = 2, GPIO_NUM_4 = 4, GPIO_NUM_5 = 5, GPIO_NUM_12 = 12,
+    GPIO_NUM_13 = 13, GPIO_NUM_14 = 14, GPIO_NUM_15 = 15, GPIO_NUM_18 = 18,
+    GPIO_NUM_19 = 19, GPIO_NUM_23 = 23, GPIO_NUM_25 = 25, GPIO_NUM_26 = 26,
+} gpio_num_t;
+
+#define GPIO_MODE_OUTPUT  0
+#define GPIO_INTR_DISABLE 0
+
+typedef struct {
+    uint64_t pin_bit_mask;
+    int mode;
+    int pull_down_en;
+    int pull_up_en;
+    int intr_type;
+} gpio_config_t;
+
+static inline esp_err_t gpio_config(const gpio_config_t *c) { (void)c; return ESP_OK; }
+static inline esp_err_t gpio_set_level(gpio_num_t pin, uint32_t level) { (void)pin; (void)level; return ESP_OK; }
@@ -0,0 +1,40 @@
+#pragma once
+// Host stub: LEDC types and no-op calls.
+#include <stdint.h>
+#include "esp_err.h"
+
+#define LEDC_HIGH_SPEED_MODE 0
+#define LEDC_TIMER_0         0
+#define LEDC_CHANNEL_0       0
+#define LEDC_TIMER_6_BIT     6
+#define LEDC_TIMER_8_BIT     8
+#define LEDC_AUTO_CLK        0
+#define LEDC_INTR_DISABLE    0
+
+typedef struct {
+    int speed_mode;
+    int duty_resolution;
+    int timer_num;
+    uint32_t freq_hz;
+    int clk_cfg;
+} ledc_timer_config_t;
+
+typedef struct {
+    int speed_mode;
+    int channel;
+    int timer_sel;
+    int intr_type;
+    int gpio_num;
+    uint32_t duty;
+    int hpoint;
+    struct {
+        unsigned output_invert : 1;
+    } flags;
+} ledc_channel_config_t;
+
+static inline esp_err_t ledc_timer_config(const ledc_timer_config_t *c) { (void)c; return ESP_OK; }
+static inline esp_err_t ledc_channel_config(const ledc_channel_config_t *c) { (void)c; return ESP_OK; }
+static inline esp_err_t ledc_set_duty(int mode, int ch, uint32_t duty) { (void)mode; (void)ch; (void)duty; return ESP_OK; }
+static inline esp_err_t ledc_update_duty(int mode, int ch) { (void)mode; (void)ch; return ESP_OK; }
+
+static inline void esp_rom_delay_us(uint32_t us) { (void)us; }
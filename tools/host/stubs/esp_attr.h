@@ -0,0 +1,4 @@
+#pragma once
+// Host stub: memory placement attributes are meaningless on Linux
+#define IRAM_ATTR
+#define DRAM_ATTR
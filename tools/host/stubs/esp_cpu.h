@@ -0,0 +1,11 @@
+#pragma once
+#include <stdint.h>
+#include <time.h>
+
+// Host stub: a 1 GHz "cycle counter" from the monotonic clock
+static inline uint32_t esp_cpu_get_cycle_count(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec);
+}
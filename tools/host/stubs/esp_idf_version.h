@@ -0,0 +1,4 @@
+#pragma once
+// Host stub: the IDF release the firmware targets (esp_driver_* split: 5.3+)
+#define ESP_IDF_VERSION_VAL(major, minor, patch) (((major) << 16) | ((minor) << 8) | (patch))
+#define ESP_IDF_VERSION ESP_IDF_VERSION_VAL(5, 3, 0)
@@ -0,0 +1,19 @@
+#pragma once
+// Host stub: just enough FreeRTOS for led_panel.c to compile on Linux.
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef uint32_t UBaseType_t;
+typedef int      BaseType_t;
+
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define pdTRUE            1
+#define pdFALSE           0
+
+// Single-threaded host: critical sections are no-ops
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux)      ((void)(mux))
+#define portEXIT_CRITICAL(mux)       ((void)(mux))
+#define portENTER_CRITICAL_SAFE(mux) ((void)(mux))
+#define portEXIT_CRITICAL_SAFE(mux)  ((void)(mux))
@@ -0,0 +1,32 @@
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+// Delays are no-ops so render loops run flat out
+static inline void vTaskDelay(TickType_t ticks) { (void)ticks; }
+static inline UBaseType_t uxTaskGetStackHighWaterMark(void *task) { (void)task; return 0; }
+
+// Task notifications: no scheduler on the host. A task is its notification
+// count plus give/take tallies for tests to check. A blocking take calls
+// host_notify_wait (if set) once per tick until something gives, which is
+// where a test plays the other side, e.g. the refresh scan.
+typedef struct { uint32_t notify, gives, takes; } host_task_t;
+typedef host_task_t *TaskHandle_t;
+
+static host_task_t host_main_task;
+static TaskHandle_t host_current_task = &host_main_task;   // the "calling" task
+static void (*host_notify_wait)(void);
+
+static inline TaskHandle_t xTaskGetCurrentTaskHandle(void) { return host_current_task; }
+static inline uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks)
+{
+    host_task_t *t = host_current_task;
+    while (t->notify == 0 && ticks-- > 0 && host_notify_wait) host_notify_wait();
+    uint32_t v = t->notify;
+    if (v) {
+        t->notify = clear ? 0 : v - 1;
+        t->takes++;
+    }
+    return v;
+}
+static inline BaseType_t xTaskNotifyGive(TaskHandle_t t) { t->notify++; t->gives++; return pdTRUE; }
+static inline void vTaskNotifyGiveFromISR(TaskHandle_t t, BaseType_t *woken) { xTaskNotifyGive(t); *woken = pdTRUE; }
@@ -0,0 +1,19 @@
+#pragma once
+// Host stub: LEDC register access as no-ops, IDF 5.1+ (hal/esp32) signatures.
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct { int unused; } ledc_dev_t;
+
+#define LEDC_LL_GET_HW()        ((ledc_dev_t *)0)
+#define LEDC_DUTY_DIR_INCREASE  1
+
+static inline void ledc_ll_set_duty_int_part(ledc_dev_t *hw, int speed_mode, int channel_num, uint32_t duty_val)
+{ (void)hw; (void)speed_mode; (void)channel_num; (void)duty_val; }
+static inline void ledc_ll_set_fade_param(ledc_dev_t *hw, int speed_mode, int channel_num,
+                                          uint32_t dir, uint32_t cycle, uint32_t scale, uint32_t step)
+{ (void)hw; (void)speed_mode; (void)channel_num; (void)dir; (void)cycle; (void)scale; (void)step; }
+static inline void ledc_ll_set_sig_out_en(ledc_dev_t *hw, int speed_mode, int channel_num, bool sig_out_en)
+{ (void)hw; (void)speed_mode; (void)channel_num; (void)sig_out_en; }
+static inline void ledc_ll_set_duty_start(ledc_dev_t *hw, int speed_mode, int channel_num, bool duty_start)
+{ (void)hw; (void)speed_mode; (void)channel_num; (void)duty_start; }
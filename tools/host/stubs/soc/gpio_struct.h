@@ -0,0 +1,10 @@
+#pragma once
+// Host stub: GPIO set/clear registers as plain memory.
+#include <stdint.h>
+
+typedef struct {
+    volatile uint32_t out_w1ts;
+    volatile uint32_t out_w1tc;
+} gpio_dev_t;
+
+static gpio_dev_t GPIO;